@@ -0,0 +1,51 @@
+################################################################################
+# Host build: the robot program from src/ linked against the simulated PROS
+# API in sim/ so it builds and runs on a desktop. `make host` builds
+# bin/host/robot; see sim/src/HostMain.cpp for its options. The simulated SD
+# card is the directory bin/host/usd. Each sim/tools/NAME.cpp links the same
+# objects into bin/host/NAME.
+################################################################################
+HOSTCXX?=g++
+HOSTBINDIR=$(BINDIR)/host
+# g++ predefines _GNU_SOURCE to 1, pros/screen.h defines it empty
+HOSTCXXFLAGS=-std=gnu++17 -O2 -g -Wall -Wno-deprecated-declarations -U_GNU_SOURCE -D_GNU_SOURCE= -pthread \
+	-iquote $(INCDIR) -I$(ROOT)/sim/include '-DUSD_ROOT="$(HOSTBINDIR)/usd/"'
+HOSTLDFLAGS=-pthread
+
+HOST_ROBOT_SRC=$(filter-out $(SRCDIR)/main.cpp,$(wildcard $(SRCDIR)/*.cpp)) $(SRCDIR)/main.cpp
+HOST_SIM_SRC=$(wildcard $(ROOT)/sim/src/*.cpp)
+HOST_ROBOT_OBJ=$(patsubst $(SRCDIR)/%.cpp,$(HOSTBINDIR)/src/%.o,$(HOST_ROBOT_SRC))
+HOST_SIM_OBJ=$(patsubst $(ROOT)/sim/src/%.cpp,$(HOSTBINDIR)/sim/%.o,$(HOST_SIM_SRC))
+# everything but HostMain's main(), for the tools
+HOST_LIB_OBJ=$(filter-out $(HOSTBINDIR)/sim/HostMain.o,$(HOST_SIM_OBJ))
+HOST_TOOL_SRC=$(wildcard $(ROOT)/sim/tools/*.cpp)
+HOST_TOOL_OBJ=$(patsubst $(ROOT)/sim/tools/%.cpp,$(HOSTBINDIR)/tools/%.o,$(HOST_TOOL_SRC))
+HOST_TOOLS=$(patsubst $(ROOT)/sim/tools/%.cpp,$(HOSTBINDIR)/%,$(HOST_TOOL_SRC))
+HOST_DEPS=$(HOST_ROBOT_OBJ:.o=.d) $(HOST_SIM_OBJ:.o=.d) $(HOST_TOOL_OBJ:.o=.d)
+
+.PHONY: host host-clean
+
+host: $(HOSTBINDIR)/robot $(HOST_TOOLS)
+
+$(HOSTBINDIR)/robot: $(HOST_ROBOT_OBJ) $(HOST_SIM_OBJ)
+	$(HOSTCXX) $(HOSTLDFLAGS) -o $@ $^
+
+$(HOST_TOOLS): $(HOSTBINDIR)/%: $(HOSTBINDIR)/tools/%.o $(HOST_ROBOT_OBJ) $(HOST_LIB_OBJ)
+	$(HOSTCXX) $(HOSTLDFLAGS) -o $@ $^
+
+$(HOSTBINDIR)/src/%.o: $(SRCDIR)/%.cpp
+	@mkdir -p $(dir $@)
+	$(HOSTCXX) $(HOSTCXXFLAGS) -MMD -MP -c -o $@ $<
+
+$(HOSTBINDIR)/sim/%.o: $(ROOT)/sim/src/%.cpp
+	@mkdir -p $(dir $@)
+	$(HOSTCXX) $(HOSTCXXFLAGS) -MMD -MP -c -o $@ $<
+
+$(HOSTBINDIR)/tools/%.o: $(ROOT)/sim/tools/%.cpp
+	@mkdir -p $(dir $@)
+	$(HOSTCXX) $(HOSTCXXFLAGS) -MMD -MP -c -o $@ $<
+
+host-clean:
+	-rm -rf $(HOSTBINDIR)
+
+-include $(HOST_DEPS)
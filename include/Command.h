@@ -0,0 +1,194 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include "main.h"
+#include "ControlScheduler.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Command based autonomous.
+// A Command is initialized once, executed every control tick until
+// isFinished() returns true, then ended. Commands declare the subsystems
+// they use as a bit mask; scheduling a command interrupts any running
+// command that needs one of the same subsystems.
+class Command {
+public:
+	virtual ~Command() = default;
+
+	virtual void initialize() {}
+	virtual void execute(double dt) {}
+	virtual bool isFinished() { return true; }
+	virtual void end(bool interrupted) {}
+
+	uint32_t getRequirements() const { return requirements; }
+
+protected:
+	uint32_t requirements = 0;
+};
+
+using CommandPtr = std::shared_ptr<Command>;
+
+// Runs a function once
+class InstantCommand : public Command {
+public:
+	explicit InstantCommand(std::function<void()> function, uint32_t requirements = 0);
+	void initialize() override;
+
+private:
+	std::function<void()> function;
+};
+
+// Finishes after a fixed time
+class WaitCommand : public Command {
+public:
+	explicit WaitCommand(uint32_t millis);
+	void initialize() override;
+	void execute(double dt) override;
+	bool isFinished() override;
+
+private:
+	double duration;
+	double elapsed = 0;
+};
+
+// Finishes once the condition is true
+class WaitUntilCommand : public Command {
+public:
+	explicit WaitUntilCommand(std::function<bool()> condition);
+	bool isFinished() override;
+
+private:
+	std::function<bool()> condition;
+};
+
+// Wraps a control step like the ones run on the ControlScheduler. The step
+// is built when the command starts, so it sees the robot state at that time.
+class StepCommand : public Command {
+public:
+	StepCommand(std::function<ControlScheduler::Callback()> factory, uint32_t requirements,
+	             std::function<void()> onInterrupt = nullptr);
+	void initialize() override;
+	void execute(double dt) override;
+	bool isFinished() override;
+	void end(bool interrupted) override;
+
+private:
+	std::function<ControlScheduler::Callback()> factory;
+	std::function<void()> onInterrupt;
+	ControlScheduler::Callback step;
+	bool finished = false;
+};
+
+// Base for groups, requires everything its children require
+class CommandGroup : public Command {
+public:
+	explicit CommandGroup(std::vector<CommandPtr> commands);
+
+protected:
+	std::vector<CommandPtr> commands;
+};
+
+// Runs commands one after another
+class SequentialGroup : public CommandGroup {
+public:
+	using CommandGroup::CommandGroup;
+	void initialize() override;
+	void execute(double dt) override;
+	bool isFinished() override;
+	void end(bool interrupted) override;
+
+	// ms each finished command took, in order, since the last initialize()
+	const std::vector<uint32_t>& getStepTimes() const { return stepTimes; }
+
+private:
+	size_t index = 0;
+	uint32_t stepStart = 0;
+	std::vector<uint32_t> stepTimes;
+};
+
+// Runs commands together until all of them finish. Children cannot share a
+// subsystem: a child that needs one an earlier child already requires is
+// left out of the group, with a message on the terminal.
+class ParallelGroup : public CommandGroup {
+public:
+	explicit ParallelGroup(std::vector<CommandPtr> commands);
+	void initialize() override;
+	void execute(double dt) override;
+	bool isFinished() override;
+	void end(bool interrupted) override;
+
+protected:
+	std::vector<bool> running;
+};
+
+// Runs commands together until any of them finishes
+class RaceGroup : public ParallelGroup {
+public:
+	using ParallelGroup::ParallelGroup;
+	bool isFinished() override;
+};
+
+// Runs commands together until the first one (the deadline) finishes
+class DeadlineGroup : public ParallelGroup {
+public:
+	using ParallelGroup::ParallelGroup;
+	bool isFinished() override;
+};
+
+template <class... Commands>
+CommandPtr sequence(Commands... commands) {
+	return std::make_shared<SequentialGroup>(std::vector<CommandPtr>{commands...});
+}
+
+template <class... Commands>
+CommandPtr parallel(Commands... commands) {
+	return std::make_shared<ParallelGroup>(std::vector<CommandPtr>{commands...});
+}
+
+template <class... Commands>
+CommandPtr race(Commands... commands) {
+	return std::make_shared<RaceGroup>(std::vector<CommandPtr>{commands...});
+}
+
+template <class... Commands>
+CommandPtr deadline(CommandPtr deadline, Commands... commands) {
+	return std::make_shared<DeadlineGroup>(std::vector<CommandPtr>{deadline, commands...});
+}
+
+// Ticks every active command once per control period.
+// schedule() and cancel() may be called from any task, commands included;
+// initialize/execute/end all run on the task that calls run(), normally the
+// ControlScheduler task, without the scheduler's lock held. A command
+// scheduled during a tick starts on the next one, and a canceled command
+// stays scheduled until the next run() ends it. Only one task may call run().
+class CommandScheduler {
+public:
+	static constexpr int MAX_COMMANDS = 8;
+
+	// false, and the command dropped, if MAX_COMMANDS are already waiting
+	// to start
+	bool schedule(CommandPtr command);
+	void cancel(const CommandPtr& command);
+	void cancelAll();
+	bool isScheduled(const CommandPtr& command);
+
+	// one tick, returns true while any command is active or pending
+	bool run(double dt);
+
+	// schedule a command and block the calling task until it finishes,
+	// ticking this scheduler from the control scheduler in the meantime;
+	// false if either scheduler had no room for it
+	bool runUntilFinished(ControlScheduler& controlScheduler, CommandPtr command);
+
+private:
+	pros::Mutex mutex;
+	CommandPtr active[MAX_COMMANDS];
+	CommandPtr pending[MAX_COMMANDS];
+	// active commands to end on the next run()
+	CommandPtr canceled[MAX_COMMANDS];
+	bool cancelingAll = false;
+};
+
+#endif
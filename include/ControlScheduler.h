@@ -0,0 +1,66 @@
+#ifndef CONTROL_SCHEDULER_H
+#define CONTROL_SCHEDULER_H
+
+#include "main.h"
+
+#include <functional>
+
+// Fixed-rate scheduler for control loops.
+// One high priority task wakes every period with pros::Task::delay_until and
+// runs each registered callback once. A callback gets the nominal period in
+// seconds and returns true when it is finished, which removes it.
+// Callbacks run outside the scheduler's lock, so one may add(), remove()
+// or check isActive() on any handle, its own included. A callback added
+// during a tick first runs on the next one.
+class ControlScheduler {
+public:
+	using Callback = std::function<bool(double dt)>;
+
+	static constexpr int MAX_CALLBACKS = 8;
+
+	struct Stats {
+		uint32_t ticks = 0;
+		uint32_t overruns = 0;     // ticks that ran past the next deadline
+		uint32_t lastJitterUs = 0; // how late the last tick started
+		uint32_t maxJitterUs = 0;
+		uint32_t lastExecUs = 0;   // time spent running callbacks in the last tick
+		uint32_t maxExecUs = 0;
+	};
+
+	explicit ControlScheduler(uint32_t periodMs);
+
+	// create the scheduler task, call from initialize()
+	void start(uint32_t priority = TASK_PRIORITY_DEFAULT + 2);
+
+	// returns a handle for remove()/isActive(), or -1 if every slot is taken
+	int add(Callback callback);
+	void remove(int handle);
+	bool isActive(int handle);
+	// drop every callback, e.g. when autonomous is stopped mid-move
+	void clear();
+
+	// register a callback and block the calling task until it finishes;
+	// false, and nothing run, if every slot is taken
+	bool run(Callback callback);
+
+	uint32_t getPeriodMs() const { return periodMs; }
+	double getDt() const { return periodMs / 1000.0; }
+
+	Stats getStats();
+	void resetStats();
+
+private:
+	void loop();
+
+	const uint32_t periodMs;
+	pros::Mutex mutex;
+	// a slot is taken while its callback is stored or running; callbacks
+	// are moved out into running for the tick and back after it
+	bool taken[MAX_CALLBACKS] = {};
+	Callback callbacks[MAX_CALLBACKS];
+	Callback running[MAX_CALLBACKS];
+	Stats stats;
+	pros::Task* task = nullptr;
+};
+
+#endif
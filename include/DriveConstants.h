@@ -0,0 +1,44 @@
+#ifndef DRIVE_CONSTANTS_H
+#define DRIVE_CONSTANTS_H
+
+#include "DriveTrain.h"
+#include "MotionProfile.h"
+#include "PoseEstimator.h"
+
+// Straight move constants, voltages in millivolts and distances in inches.
+// main.cpp drives with these and the host tools (PidTuner,
+// TrackingBenchmark) simulate the same moves with them, so a retune here
+// is what both see.
+const double DRIVE_MAX_ACCEL = 60;
+const double DRIVE_JERK_TIME = 0.1;
+// ProfileFollower ends the move once within this many inches
+const double DRIVE_TOLERANCE = 0.5;
+const Feedforward DRIVE_FEEDFORWARD = {600, 12000 / DriveTrain::MAX_SPEED, 15};
+// feedback gains by distance from the reference: stiffer within the last
+// couple of inches so the end of the move closes, with an integral only there
+const GainSchedule DRIVE_GAINS(GainSchedule::Key::ERROR, {
+    {0.5, {1200, 400, 60}},
+    {2, {800, 0, 50}},
+    {6, {400, 0, 40}},
+});
+// heading hold during straight moves, millivolts per degree of drift
+const double HEADING_KP = 150;
+const int HEADING_MAX_CORRECTION = 3000;
+// what the ProfileFollower of a straight move may ask for, leaving the
+// heading hold its room below the motors' limit
+const double DRIVE_MAX_VOLTAGE = DriveTrain::MAX_VOLTAGE - HEADING_MAX_CORRECTION;
+
+// Moves drive_gain_check() scores, the same ones bin/host/PidTuner tunes
+// DRIVE_GAINS on in the simulator; they end where they started
+const double GAIN_CHECK_MOVES[] = {6, -6, 24, -24, 48, -48};
+// power the moves are driven at, 0 to DriveTrain::MAX_POWER
+const int GAIN_CHECK_POWER = 50;
+// each move is scored over this long, holding still once it finishes
+const double GAIN_CHECK_SECONDS = 4;
+
+// Sensor and motion noise for the robot's pose estimate, which
+// bin/host/PoseBenchmark checks against the same sensor errors:
+// acceleration, angular acceleration, encoder, slip, IMU heading, rate, drift
+const PoseEstimator::Noise POSE_NOISE = {400, 10, 1.5, 6, 0.5, 0.5, 0.1};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef DRIVE_TRAIN_H
+#define DRIVE_TRAIN_H
+
+#include "main.h"
+#include "RobotSpecifics.h"
+
+#include <array>
+
+// Six motor tank drive.
+// Wiring and reversal come from the port tables in RobotSpecifics.h, so
+// callers always use positive = forward. Every set call computes all six
+// outputs and flushes them together; a motor is only sent a command when
+// its mode or value changed since the last flush.
+class DriveTrain {
+public:
+	static constexpr int SIDE_MOTORS = 3;
+	static constexpr int MAX_POWER = 127;     // pros::Motor::move scale
+	static constexpr int MAX_VOLTAGE = 12000; // millivolts
+	// cartridge matching DRIVE_MAX_RPM, so velocities read in real rpm
+	static constexpr pros::motor_gearset_e_t GEARSET = DRIVE_MAX_RPM == 600   ? pros::E_MOTOR_GEARSET_06
+	                                                   : DRIVE_MAX_RPM == 200 ? pros::E_MOTOR_GEARSET_18
+	                                                                          : pros::E_MOTOR_GEARSET_36;
+	static constexpr double WHEEL_CIRCUMFERENCE = DRIVE_WHEEL_DIAMETER * 3.14159265358979;
+	static constexpr double TICKS_PER_INCH = DRIVE_TICKS_PER_REV / (WHEEL_CIRCUMFERENCE * DRIVE_GEAR_RATIO);
+	// free speed of the wheels at full voltage
+	static constexpr double MAX_SPEED = DRIVE_MAX_RPM * DRIVE_GEAR_RATIO * WHEEL_CIRCUMFERENCE / 60;
+
+	DriveTrain();
+
+	// -127 to 127, same scale as pros::Motor::move
+	void setPower(int left, int right);
+	// millivolts, -12000 to 12000
+	void setVoltage(int left, int right);
+	// rpm for the configured gearset, uses the motors' velocity PID
+	void setVelocity(int left, int right);
+	// -100 to 100 percent of full voltage
+	void setPercent(double left, double right);
+	void stop();
+
+	// forget what was sent so the next flush resends every motor; call it
+	// when a competition mode starts, the motors may have been stopped by
+	// the field since the last command
+	void invalidate();
+
+	void setBrakeMode(pros::motor_brake_mode_e_t mode);
+	void setEncoderUnits(pros::motor_encoder_units_e_t units);
+
+	// encoder position of the front motor on each side, positive = forward
+	double getLeftPosition() const;
+	double getRightPosition() const;
+	// same as above in inches and inches per second, needs encoder units in counts
+	double getLeftDistance() const;
+	double getRightDistance() const;
+	double getLeftSpeed() const;
+	double getRightSpeed() const;
+	// every motor's distance in inches, left then right, front to back
+	void getDistances(std::array<double, 2 * SIDE_MOTORS>& distances) const;
+
+	pros::Motor& left(int i) { return motors[i]; }
+	pros::Motor& right(int i) { return motors[SIDE_MOTORS + i]; }
+
+private:
+	enum class Mode : uint8_t { NONE, VOLTAGE, VELOCITY };
+
+	struct Command {
+		Mode mode = Mode::NONE;
+		int32_t value = 0;
+	};
+
+	void set(Mode mode, int32_t left, int32_t right);
+	void flush();
+
+	pros::Motor motors[2 * SIDE_MOTORS];
+	Command pending[2 * SIDE_MOTORS];
+	Command sent[2 * SIDE_MOTORS];
+};
+
+#endif
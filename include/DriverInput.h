@@ -0,0 +1,130 @@
+#ifndef DRIVER_INPUT_H
+#define DRIVER_INPUT_H
+
+#include <array>
+#include <cstdint>
+
+// Joystick conditioning for driver control.
+// Response curves (deadband + cubic or exponential shaping) are built at
+// compile time into 256 entry lookup tables indexed by the raw analog value,
+// so each loop only does a table read per axis. Mixing keeps the ratio
+// between the sides when one would saturate, and a slew limiter bounds how
+// fast each side can speed up.
+
+using CurveTable = std::array<int8_t, 256>;
+
+namespace curve {
+
+constexpr int MAX = 127;
+
+constexpr double exp(double x) {
+	// exp(x) = exp(x / 2^8) ^ (2^8), with a short series for the small argument
+	double small = x / 256;
+	double term = 1;
+	double sum = 1;
+	for (int i = 1; i < 12; i++) {
+		term *= small / i;
+		sum += term;
+	}
+	for (int i = 0; i < 8; i++) {
+		sum *= sum;
+	}
+	return sum;
+}
+
+// input with the deadband removed, rescaled back to 0..1
+constexpr double normalize(int value, int deadband) {
+	int magnitude = value < 0 ? -value : value;
+	if (magnitude > MAX) {
+		magnitude = MAX;
+	}
+	if (magnitude <= deadband) {
+		return 0;
+	}
+	return (double) (magnitude - deadband) / (MAX - deadband);
+}
+
+constexpr int8_t toOutput(int value, double shaped) {
+	int out = (int) (shaped * MAX + 0.5);
+	return (int8_t) (value < 0 ? -out : out);
+}
+
+} // namespace curve
+
+// index a table with the raw analog value (-127 to 127)
+constexpr int8_t applyCurve(const CurveTable& table, int value) {
+	return table[(uint8_t) (value + 128)];
+}
+
+constexpr CurveTable makeLinearCurve(int deadband) {
+	CurveTable table{};
+	for (int i = 0; i < 256; i++) {
+		int value = i - 128;
+		table[i] = curve::toOutput(value, curve::normalize(value, deadband));
+	}
+	return table;
+}
+
+// weight 0 is linear, 1 is a pure cube
+constexpr CurveTable makeCubicCurve(int deadband, double weight) {
+	CurveTable table{};
+	for (int i = 0; i < 256; i++) {
+		int value = i - 128;
+		double x = curve::normalize(value, deadband);
+		table[i] = curve::toOutput(value, weight * x * x * x + (1 - weight) * x);
+	}
+	return table;
+}
+
+// larger sharpness gives finer control near the center
+constexpr CurveTable makeExponentialCurve(int deadband, double sharpness) {
+	CurveTable table{};
+	for (int i = 0; i < 256; i++) {
+		int value = i - 128;
+		double x = curve::normalize(value, deadband);
+		table[i] = curve::toOutput(value, (curve::exp(sharpness * x) - 1) / (curve::exp(sharpness) - 1));
+	}
+	return table;
+}
+
+// Limits how much an output may grow per tick. Slowing down or stopping is
+// never limited so the robot always brakes when the stick is released.
+class SlewLimiter {
+public:
+	explicit SlewLimiter(int maxStep) : maxStep(maxStep) {}
+
+	int step(int target);
+	void reset(int value = 0) { current = value; }
+
+private:
+	int maxStep;
+	int current = 0;
+};
+
+class DriverInput {
+public:
+	struct Output {
+		int left;
+		int right;
+	};
+
+	DriverInput(const CurveTable& forwardCurve, const CurveTable& turnCurve, int slewPerTick);
+
+	// forward + turn, scaled down together if either side would pass 127
+	Output arcade(int forward, int turn);
+	// turn sets the path curvature, scaled by forward speed; below
+	// quickTurnThreshold it falls back to turning in place
+	Output curvature(int forward, int turn, int quickTurnThreshold = 10);
+
+	void reset();
+
+private:
+	Output mix(int left, int right);
+
+	const CurveTable& forwardCurve;
+	const CurveTable& turnCurve;
+	SlewLimiter leftSlew;
+	SlewLimiter rightSlew;
+};
+
+#endif
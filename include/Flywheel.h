@@ -0,0 +1,68 @@
+#ifndef FLYWHEEL_H
+#define FLYWHEEL_H
+
+#include "main.h"
+#include "VelocityEstimator.h"
+#include "okapi/api/filter/emaFilter.hpp"
+
+#include <atomic>
+
+// Closed loop flywheel velocity control.
+// A dedicated task estimates the wheel speed from the motor's timestamped
+// encoder readings, smooths each new estimate with an EMA and drives the
+// motor with kV feedforward plus a take-back-half
+// correction. Far below the target it switches to full voltage (bang-bang)
+// to recover from a shot as fast as possible. The task tracks whether the
+// wheel is at speed and how long the last recovery took.
+class Flywheel {
+public:
+	struct Gains {
+		double kV;            // millivolts per rpm
+		double tbhGain;       // millivolts per rpm of error per tick
+		double bangBangError; // rpm below target to switch to full voltage
+		double tolerance;     // rpm counted as at speed
+		double shotDrop;      // rpm drop from at speed that means a shot went through
+		uint32_t settleTicks; // ticks inside tolerance before reporting at speed
+	};
+
+	Flywheel(uint8_t port, const Gains& gains, double filterAlpha = 0.3, uint32_t periodMs = 10);
+
+	// create the control task, call from initialize()
+	void start(uint32_t priority = TASK_PRIORITY_DEFAULT + 1);
+
+	void setTarget(int32_t rpm);
+	int32_t getTarget() const { return target; }
+	double getVelocity() const { return velocity; }
+
+	bool isAtSpeed() const { return atSpeed; }
+	bool isRecovering() const { return recovering; }
+	// milliseconds from the last shot until the wheel was back at speed
+	uint32_t getLastRecoveryTime() const { return lastRecoveryTime; }
+
+private:
+	void loop();
+	void step();
+
+	pros::Motor motor;
+	const Gains gains;
+	const uint32_t periodMs;
+	VelocityEstimator estimator;
+	okapi::EmaFilter filter;
+
+	std::atomic<int32_t> target{0};
+	std::atomic<double> velocity{0};
+	std::atomic<bool> atSpeed{false};
+	std::atomic<bool> recovering{false};
+	std::atomic<uint32_t> lastRecoveryTime{0};
+
+	// only touched by the control task
+	int32_t activeTarget = 0;
+	double tbh = 0;
+	double output = 0;
+	double lastError = 0;
+	uint32_t ticksInTolerance = 0;
+	uint32_t shotTime = 0;
+	pros::Task* task = nullptr;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "main.h"
+
+#include <atomic>
+
+// Always-on latency instrumentation.
+// Each LatencySection keeps a fixed log-scale histogram (4 buckets per
+// power of two microseconds) plus count, total and max. Recording is a few
+// relaxed atomic operations with no allocation or locking, so a section may
+// be recorded from several tasks, like drive_flush from the control task and
+// opcontrol. A reader may see one sample's fields half updated, which only
+// shifts that one sample. Sections register themselves at construction, so
+// define them at file scope.
+class LatencySection {
+public:
+	static constexpr int SUB_BUCKETS = 4;
+	static constexpr int BUCKETS = 32 * SUB_BUCKETS;
+
+	explicit LatencySection(const char* name);
+
+	void record(uint32_t micros);
+	void reset();
+
+	const char* getName() const { return name; }
+	uint32_t getCount() const { return count.load(std::memory_order_relaxed); }
+	uint32_t getMax() const { return max.load(std::memory_order_relaxed); }
+	uint32_t getMean() const;
+	// upper bound of the bucket holding the given percentile (0-100)
+	uint32_t getPercentile(double percentile) const;
+
+	// print every registered section to the serial terminal
+	static void dumpAll();
+	static void resetAll();
+
+private:
+	static int bucketOf(uint32_t micros);
+	static uint32_t bucketLimit(int bucket);
+
+	const char* name;
+	std::atomic<uint32_t> buckets[BUCKETS] = {};
+	std::atomic<uint32_t> count{0};
+	std::atomic<uint32_t> max{0};
+	std::atomic<uint64_t> total{0};
+};
+
+// Records the time from construction to destruction into a section
+class ScopedTimer {
+public:
+	explicit ScopedTimer(LatencySection& section) : section(section), start(pros::micros()) {}
+	~ScopedTimer() { section.record((uint32_t) (pros::micros() - start)); }
+
+private:
+	LatencySection& section;
+	uint64_t start;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef MATCH_RECORDER_H
+#define MATCH_RECORDER_H
+
+#include "main.h"
+
+#include <atomic>
+#include <cstdio>
+#include <initializer_list>
+
+// Where logs go. The host build points this at a local directory.
+#ifndef USD_ROOT
+#define USD_ROOT "/usd/"
+#endif
+
+// Everything one driver control loop iteration acted on: the controller
+// values and the motor and IMU readings at the top of the loop. Readings are
+// kept at the resolution the brain reports them (counts, mA, mV) or in fixed
+// point.
+struct MatchFrame {
+	static constexpr int MAX_MOTORS = 12;
+
+	uint32_t time = 0; // ms since the recording started
+	int8_t analog[4] = {};
+	uint16_t digital = 0;  // bit 0 is E_CONTROLLER_DIGITAL_L1
+	uint16_t newPress = 0; // same bits, get_digital_new_press results
+	int32_t position[MAX_MOTORS] = {}; // get_raw_position counts
+	int32_t velocity[MAX_MOTORS] = {}; // get_actual_velocity, centi-rpm
+	int32_t current[MAX_MOTORS] = {};  // mA
+	int32_t voltage[MAX_MOTORS] = {};  // mV
+	int32_t rotation = 0; // IMU get_rotation, millidegrees
+	int32_t rate = 0;     // IMU get_gyro_rate().z, centidegrees per second
+};
+
+// Log layout: "CPVX" magic, version, motor count, motor ports, IMU port, then
+// blocks of up to BLOCK_SIZE bytes, each a 16 bit length and frames. A frame
+// is varints of the change from the frame before it (zigzag for signed
+// fields, xor for button masks); the first frame of every block is relative
+// to an all zero frame, so each block decodes on its own.
+class MatchLog {
+public:
+	static constexpr int BLOCK_SIZE = 4096;
+	static constexpr uint8_t VERSION = 1;
+	// worst case varint bytes for one frame
+	static constexpr int MAX_FRAME_BYTES = 5 * (1 + 4 + 2 + 4 * MatchFrame::MAX_MOTORS + 2);
+
+	// returns the bytes written to out
+	static int encode(const MatchFrame& previous, const MatchFrame& frame, int motorCount, uint8_t* out);
+	// returns the bytes read, or 0 if the frame runs past end
+	static int decode(const MatchFrame& previous, const uint8_t* in, const uint8_t* end, int motorCount,
+	                  MatchFrame& frame);
+};
+
+// Reads a log back frame by frame
+class MatchReader {
+public:
+	~MatchReader();
+
+	bool open(const char* path);
+	void close();
+	// false at the end of the log
+	bool next(MatchFrame& frame);
+
+	int getMotorCount() const { return motorCount; }
+	const uint8_t* getPorts() const { return ports; }
+	uint8_t getImuPort() const { return imuPort; }
+
+private:
+	bool readBlock();
+
+	FILE* file = nullptr;
+	int motorCount = 0;
+	uint8_t ports[MatchFrame::MAX_MOTORS] = {};
+	uint8_t imuPort = 0;
+	uint8_t block[MatchLog::BLOCK_SIZE];
+	int blockLength = 0;
+	int offset = 0;
+	MatchFrame previous;
+};
+
+// Match recorder for driver control.
+// capture() reads the controller and sensors once at the top of the loop and
+// the loop acts on the captured values. Frames are encoded into one of a few
+// preallocated blocks; a low priority task writes full blocks to the SD card,
+// so the loop never waits on the card. If every block is waiting to be
+// written, frames are dropped and counted instead.
+class MatchRecorder {
+public:
+	static constexpr int BLOCKS = 4;
+
+	// loads a replayed frame's readings into whatever the code reads from
+	using ReplayHook = void (*)(const MatchFrame& frame, const MatchReader& reader);
+
+	MatchRecorder(pros::Controller& controller, std::initializer_list<uint8_t> motorPorts, uint8_t imuPort);
+
+	// Open the next free USD_ROOT/matchNNN.bin and start recording. Returns
+	// false (and captures without recording) when there is no SD card.
+	bool start(uint32_t priority = TASK_PRIORITY_MIN + 1);
+	// Write out what is buffered, close the log and print how many frames it
+	// holds and how many were dropped. Blocks until the writer catches up, so
+	// call it from disabled().
+	void stop();
+
+	void capture();
+
+	int32_t analog(pros::controller_analog_e_t channel) const;
+	bool digital(pros::controller_digital_e_t button) const;
+	bool newPress(pros::controller_digital_e_t button) const;
+
+	uint32_t getFrames() const { return frames; }
+	uint32_t getDropped() const { return dropped; }
+
+	// Every recorder started after this plays path back instead of reading
+	// the hardware, passing each frame to hook first. For the host replayer.
+	static void replayFrom(const char* path, ReplayHook hook);
+	// true once a replayed log has run out
+	bool isReplayDone() const { return replayDone; }
+
+private:
+	enum BlockState : uint8_t { FREE, FILLING, FULL };
+
+	void read(MatchFrame& frame);
+	void append(const MatchFrame& frame);
+	void finishBlock();
+	void writeLoop();
+
+	pros::Controller& controller;
+	int motorCount = 0;
+	uint8_t ports[MatchFrame::MAX_MOTORS] = {};
+	uint8_t imuPort;
+
+	MatchFrame frame;
+	MatchFrame previous; // last frame encoded into the current block
+	uint32_t startTime = 0;
+	uint32_t frames = 0;
+	uint32_t dropped = 0;
+
+	FILE* file = nullptr;
+	uint8_t blocks[BLOCKS][MatchLog::BLOCK_SIZE];
+	uint16_t lengths[BLOCKS] = {};
+	std::atomic<uint8_t> states[BLOCKS];
+	int filling = 0;  // block capture() appends to
+	int writing = 0;  // next block the writer task writes
+	pros::Task* writer = nullptr;
+
+	MatchReader replay;
+	bool replaying = false;
+	bool replayDone = false;
+	static const char* replayPath;
+	static ReplayHook replayHook;
+};
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+// Straight line motion profiles and a feedforward + feedback follower.
+// Nothing in here touches PROS, so it can be built and exercised on the host.
+
+#include <initializer_list>
+
+struct ProfileState {
+	double position = 0;     // inches
+	double velocity = 0;     // inches per second
+	double acceleration = 0; // inches per second squared
+};
+
+// Trapezoidal velocity profile over a signed distance. With a non-zero
+// jerkTime the trapezoid is averaged over a sliding window of that length,
+// which turns it into an S-curve whose acceleration ramps linearly over
+// jerkTime seconds. The distance is unchanged and the move takes jerkTime
+// longer.
+class MotionProfile {
+public:
+	MotionProfile(double distance, double maxVelocity, double maxAcceleration, double jerkTime = 0);
+
+	ProfileState sample(double t) const;
+	double getDuration() const { return accelTime * 2 + cruiseTime + jerkTime; }
+	double getDistance() const { return direction * distance; }
+
+private:
+	// position of the underlying trapezoid and its integral over time
+	double trapezoidPosition(double t) const;
+	double trapezoidIntegral(double t) const;
+	ProfileState trapezoidState(double t) const;
+
+	double direction;
+	double distance; // magnitude
+	double acceleration;
+	double peakVelocity;
+	double accelTime;
+	double cruiseTime;
+	double jerkTime;
+};
+
+// Drive feedforward in millivolts: kS to break static friction, kV per in/s
+// and kA per in/s^2.
+struct Feedforward {
+	double kS;
+	double kV;
+	double kA;
+
+	double calculate(double velocity, double acceleration) const;
+};
+
+// PID gains in millivolts per inch, per inch second and per in/s
+struct PidGains {
+	double kP;
+	double kI;
+	double kD;
+};
+
+// PID gains looked up from a table keyed on the size of the error (inches)
+// or on the battery voltage (millivolts), so a move can push hard while far
+// away and gently near the target, or keep the same response as the
+// battery sags. Between points the gains are interpolated linearly; past
+// either end they hold the end point's gains.
+class GainSchedule {
+public:
+	enum class Key { ERROR, BATTERY };
+	static constexpr int MAX_POINTS = 8;
+
+	struct Point {
+		double key;
+		PidGains gains;
+	};
+
+	// the same gains everywhere
+	GainSchedule(const PidGains& gains);
+	// up to MAX_POINTS points in increasing key order
+	GainSchedule(Key key, std::initializer_list<Point> points);
+	GainSchedule(Key key, const Point* points, int count);
+
+	Key getKey() const { return key; }
+	int getCount() const { return count; }
+	const Point& getPoint(int i) const { return points[i]; }
+	PidGains lookup(double value) const;
+
+private:
+	Key key = Key::ERROR;
+	Point points[MAX_POINTS];
+	int count = 0;
+};
+
+// How much of the reference the P and D terms see (setpoint weighting).
+// P acts on proportional * reference - position and D on derivative *
+// reference velocity - velocity; the integral always sees the full error.
+// With both at 1 this is PID on the tracking error, which is what a smooth
+// profile with feedforward wants. For a reference that jumps, such as a
+// bare target position, lower weights soften the kick without changing how
+// disturbances are rejected, since those only show up in the measurement.
+// A proportional weight below 1 leaves an offset that the integral removes.
+struct SetpointWeights {
+	double proportional = 1;
+	double derivative = 1;
+};
+
+// Two degree of freedom tracking controller: feedforward from the
+// reference trajectory does the work of following it, and scheduled PID
+// with setpoint weighting corrects what the feedforward misses. Call
+// update() every control tick with the reference at that time; it returns
+// millivolts. The integral stops growing while the output is saturated.
+//
+// This is not built on okapi's IterativePosPIDController: its step() takes
+// only a new reading against a fixed target, while this needs the whole
+// reference (position, velocity and acceleration) every tick for the
+// feedforward and the setpoint weights.
+class TrackingController {
+public:
+	static constexpr double NOMINAL_BATTERY = 12800; // millivolts
+
+	TrackingController(const Feedforward& feedforward, const GainSchedule& schedule, double maxVoltage,
+	                   const SetpointWeights& weights = SetpointWeights());
+
+	// dt in seconds, measured position in inches and velocity in in/s,
+	// battery in millivolts for a schedule keyed on it
+	double update(double dt, const ProfileState& reference, double position, double velocity,
+	              double battery = NOMINAL_BATTERY);
+	void reset();
+
+	double getError() const { return error; }
+	// the scheduled gains used by the last update()
+	const PidGains& getGains() const { return gains; }
+
+private:
+	Feedforward feedforward;
+	GainSchedule schedule;
+	double maxVoltage;
+	SetpointWeights weights;
+	PidGains gains = {0, 0, 0};
+	double integral = 0;
+	double error = 0;
+};
+
+// Follows a MotionProfile with feedforward plus position and velocity
+// feedback. Call update() every control tick with the time since start and
+// the measured position and velocity, it returns the voltage to apply,
+// within maxVoltage. Pass what the caller can actually apply, so the
+// integral stops growing where the motors saturate: a caller that adds its
+// own correction on top, like drive_straight's heading hold, passes the
+// motor limit less the room it keeps for that.
+class ProfileFollower {
+public:
+	struct Gains {
+		double kP;  // millivolts per inch of position error
+		double kD;  // millivolts per in/s of velocity error
+	};
+
+	ProfileFollower(const MotionProfile& profile, const Feedforward& feedforward, const Gains& gains,
+	                double maxVoltage, double tolerance = 0.5, double timeout = 1.0);
+	// scheduled PID feedback, see TrackingController
+	ProfileFollower(const MotionProfile& profile, const Feedforward& feedforward, const GainSchedule& schedule,
+	                double maxVoltage, double tolerance = 0.5, double timeout = 1.0);
+
+	double update(double t, double position, double velocity);
+
+	// true once the profile has finished and the robot is within tolerance,
+	// or timeout seconds after the profile finished
+	bool isFinished() const { return finished; }
+	const ProfileState& getReference() const { return reference; }
+	double getError() const { return error; }
+
+private:
+	MotionProfile profile;
+	TrackingController controller;
+	double tolerance;
+	double timeout;
+	ProfileState reference;
+	double error = 0;
+	double lastTime = 0;
+	bool finished = false;
+};
+
+// Scores a move to a target the same way on the robot and in the
+// simulator's tuning tools: the integral of time times absolute error
+// (ITAE, which weighs the end of the move most), overshoot, and the time
+// after which the error stayed within tolerance. Call add() every control
+// tick with the time since the start of the move.
+class MoveScore {
+public:
+	// distance and tolerance in inches; stoppedSpeed in in/s counts as at rest
+	explicit MoveScore(double distance, double tolerance = 0.5, double stoppedSpeed = 1);
+
+	void add(double t, double dt, double position, double velocity);
+
+	// inch seconds^2
+	double getItae() const { return itae; }
+	// inches past the target, 0 if it never got there
+	double getOvershoot() const { return overshoot; }
+	// within tolerance and at rest at the last add()
+	bool isSettled() const;
+	// seconds, the time scored so far if it has not settled
+	double getSettleTime() const { return isSettled() ? settleTime : elapsed; }
+	double getError() const { return error; }
+
+private:
+	double distance;
+	double tolerance;
+	double stoppedSpeed;
+	double itae = 0;
+	double overshoot = 0;
+	double settleTime = 0;
+	double elapsed = 0;
+	double error = 0;
+	double velocity = 0;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef POSE_ESTIMATOR_H
+#define POSE_ESTIMATOR_H
+
+#include "okapi/api/filter/kalmanFilter.hpp"
+
+#include <array>
+
+// Field pose from every drive encoder, the IMU and optional absolute
+// readings (GPS, distance sensors to a wall), fused by an extended Kalman
+// filter over (x, y, heading, velocity, turn rate). A sixth state tracks how
+// far the IMU's heading has drifted, which absolute readings can correct.
+// Everything is sized at compile time, so a tick does a few thousand flops
+// and no allocation.
+// Like MotionProfile this has no PROS dependency; the caller reads the
+// sensors and passes the values in.
+//
+// Field frame: inches, heading in radians counterclockwise from +x. The IMU
+// reports clockwise degrees, so updateImu() takes getRotation() and
+// getRotationRate() as they are and converts.
+class PoseEstimator {
+public:
+	enum { X, Y, HEADING, VELOCITY, TURN_RATE, IMU_DRIFT, STATES };
+	static constexpr int DRIVE_ENCODERS = 6;
+
+	using Filter = okapi::KalmanFilter<STATES>;
+
+	struct Pose {
+		double x;
+		double y;
+		double heading;
+	};
+
+	// standard deviations of the sensors and of the motion model
+	struct Noise {
+		double acceleration;        // in/s^2, how fast the velocity changes unannounced
+		double angularAcceleration; // rad/s^2, same for the turn rate
+		double encoder;             // in/s, one motor's speed reading on its own
+		double slip;                // in/s, wheel slip, shared by the motors on a side
+		double imuHeading;          // degrees
+		double imuRate;             // degrees per second
+		double imuDrift;            // degrees per root second, how fast the IMU wanders
+	};
+
+	// A distance sensor on the robot, pointing along angle (radians
+	// counterclockwise from forward) from (x forward, y left) in inches
+	struct DistanceSensor {
+		double x;
+		double y;
+		double angle;
+		double noise; // inches
+	};
+
+	// A straight field wall, the points p with normal . p == offset;
+	// for example the x = 144 wall is {1, 0, 144}
+	struct Wall {
+		double normalX;
+		double normalY;
+		double offset;
+	};
+
+	PoseEstimator(double trackWidth, const Noise& noise);
+
+	// set the pose, e.g. at the start of autonomous; the robot is at rest and
+	// the next IMU reading is taken to point along pose.heading
+	void reset(const Pose& pose);
+
+	// advance the estimate by dt seconds at the current velocity and turn rate
+	void predict(double dt);
+
+	// distances in inches of each drive wheel, left then right, front to back,
+	// and the seconds since the previous call; the first call only records
+	// the distances
+	void updateDrive(const std::array<double, DRIVE_ENCODERS>& distances, double dt);
+
+	// rotation in degrees and rate in degrees per second, both clockwise
+	void updateImu(double rotation, double rate);
+
+	// an absolute pose, e.g. from the GPS sensor, with its standard deviation
+	// in inches and radians; returns false if rejected as an outlier
+	bool updatePose(const Pose& pose, double positionNoise, double headingNoise);
+
+	// a distance sensor reading in inches to a wall; returns false if the
+	// sensor is not facing the wall or the reading is an outlier (e.g. it hit
+	// another robot)
+	bool updateDistance(const DistanceSensor& sensor, const Wall& wall, double distance);
+
+	Pose getPose() const;
+	double getVelocity() const { return filter.getState()[VELOCITY]; }
+	double getTurnRate() const { return filter.getState()[TURN_RATE]; }
+	const Filter& getFilter() const { return filter; }
+
+private:
+	double trackWidth;
+	Noise noise;
+	Filter filter;
+	std::array<double, DRIVE_ENCODERS> lastDistances{};
+	bool haveDistances = false;
+	// field heading minus IMU heading, radians
+	double imuOffset = 0;
+	bool haveImuOffset = false;
+};
+
+#endif
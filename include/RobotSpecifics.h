@@ -10,4 +10,42 @@
  #define GREEN
  // #define GOLD
 
+#if defined(GREEN) == defined(GOLD)
+#error "Define exactly one of GREEN or GOLD in RobotSpecifics.h"
+#endif
+
+#include <cstdint>
+
+// A smart port and whether the motor spins backwards for a positive command
+struct MotorPort {
+	uint8_t port;
+	bool reversed;
+};
+
+// Drive motor wiring, front/upper/back on each side.
+// Positive commands drive the robot forward.
+#ifdef GREEN
+constexpr MotorPort LEFT_DRIVE_PORTS[3] = {{11, true}, {13, false}, {12, true}};
+constexpr MotorPort RIGHT_DRIVE_PORTS[3] = {{20, false}, {18, true}, {19, false}};
+
+// Drive geometry: 3.25" wheels, 36:48 from the blue (600 rpm) cartridge
+constexpr double DRIVE_WHEEL_DIAMETER = 3.25;      // inches
+constexpr double DRIVE_GEAR_RATIO = 36.0 / 48.0;  // wheel turns per motor turn
+constexpr double DRIVE_TICKS_PER_REV = 300;       // encoder counts per motor turn
+constexpr double DRIVE_MAX_RPM = 600;
+constexpr double DRIVE_TRACK_WIDTH = 11.5;        // inches between left and right wheels, rough guess until measured
+#endif
+
+#ifdef GOLD
+// not measured yet, same wiring as GREEN
+constexpr MotorPort LEFT_DRIVE_PORTS[3] = {{11, true}, {13, false}, {12, true}};
+constexpr MotorPort RIGHT_DRIVE_PORTS[3] = {{20, false}, {18, true}, {19, false}};
+
+constexpr double DRIVE_WHEEL_DIAMETER = 3.25;
+constexpr double DRIVE_GEAR_RATIO = 36.0 / 48.0;
+constexpr double DRIVE_TICKS_PER_REV = 300;
+constexpr double DRIVE_MAX_RPM = 600;
+constexpr double DRIVE_TRACK_WIDTH = 11.5;
+#endif
+
 #endif
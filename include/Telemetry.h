@@ -0,0 +1,57 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "main.h"
+
+// LCD telemetry sink.
+// Control code publishes typed values into a fixed slot table (no allocation,
+// no formatting). A low priority task snapshots the table, formats each line
+// into a fixed char buffer and only redraws the lines that changed, at most
+// once per LVGL refresh period.
+class Telemetry {
+public:
+	static constexpr int LINES = 8;
+	static constexpr int LINE_LENGTH = 48;
+
+	explicit Telemetry(uint32_t refreshMs = LV_REFR_PERIOD);
+
+	// create the formatting task, call from initialize() after lcd::initialize()
+	void start(uint32_t priority = TASK_PRIORITY_MIN + 1);
+
+	// label must be a string literal (only the pointer is kept)
+	void publish(int line, const char* label, double value, int precision = 2);
+	void publish(int line, const char* label, int value);
+	// two related counts on one line, shown as "label: first / second"
+	void publish(int line, const char* label, int first, int second);
+	void publish(int line, const char* text);
+	void clear(int line);
+
+private:
+	enum class Type : uint8_t { EMPTY, TEXT, INT, INT_PAIR, DOUBLE };
+
+	struct Slot {
+		Type type = Type::EMPTY;
+		uint8_t precision = 0;
+		const char* label = nullptr;
+		union {
+			int i;
+			int pair[2];
+			double d;
+		};
+		Slot() : d(0) {}
+	};
+
+	void set(int line, const Slot& slot);
+	void loop();
+	static void format(const Slot& slot, char* out);
+
+	const uint32_t refreshMs;
+	pros::Mutex mutex;
+	Slot published[LINES]; // written by control code
+	Slot snapshot[LINES];  // owned by the telemetry task
+	bool dirty = false;
+	char rendered[LINES][LINE_LENGTH] = {};
+	pros::Task* task = nullptr;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef TURN_CONTROLLER_H
+#define TURN_CONTROLLER_H
+
+#include "okapi/api/control/util/windowedSettledUtil.hpp"
+
+// PID + static friction feedforward for turning in place.
+// The caller supplies the wrapped heading error and the measured turn rate
+// each tick; the derivative term works on the measured rate so setpoint
+// changes do not kick. Settling is judged on a window of errors (see
+// okapi::SettleWindow), which can end the turn before the dwell time when
+// the error is visibly decaying into the band. Like MotionProfile this has
+// no PROS dependency.
+class TurnController {
+public:
+	struct Gains {
+		double kP;          // millivolts per degree
+		double kI;          // millivolts per degree second
+		double kD;          // millivolts per degree per second
+		double kS;          // millivolts to overcome static friction
+		double integralZone; // only integrate within this many degrees
+	};
+
+	struct Settle {
+		double error;   // degrees, RMS over the window and at the newest sample
+		double rate;    // degrees per second, measured and the error's trend
+		double time;    // seconds the window spans
+		double timeout; // seconds before giving up
+	};
+
+	TurnController(const Gains& gains, const Settle& settle, double maxVoltage);
+
+	// error in degrees (target - heading, wrapped), rate in degrees per second
+	// in the same direction as the heading; returns millivolts to turn right
+	double update(double dt, double error, double rate);
+
+	bool isSettled() const { return settled; }
+	// settled on the decay envelope before the window spanned settle.time
+	bool isSettledEarly() const { return settled && window.isPredicted(); }
+	bool isTimedOut() const { return elapsed >= settle.timeout; }
+	bool isFinished() const { return settled || isTimedOut(); }
+	double getElapsed() const { return elapsed; }
+
+private:
+	Gains gains;
+	Settle settle;
+	double maxVoltage;
+	double integral = 0;
+	double lastError = 0;
+	okapi::SettleWindow window;
+	double elapsed = 0;
+	bool settled = false;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef VELOCITY_ESTIMATOR_H
+#define VELOCITY_ESTIMATOR_H
+
+#include "main.h"
+
+// Motor velocity from raw encoder counts and the brain's timestamp of each
+// reading, instead of the position change over the loop period. The motor
+// only reports every 10 ms, so a loop running at the same rate sometimes
+// sees the same reading twice and sometimes skips one; dividing by the loop
+// period turns that and scheduler jitter into velocity noise. Here repeated
+// readings are dropped and the derivative is fitted against the readings'
+// own timestamps over the last few samples:
+//  - SLOPE: least squares line, the average speed over the window; it lags
+//    by half the window while accelerating
+//  - SAVITZKY_GOLAY: least squares quadratic evaluated at the newest sample,
+//    no lag under constant acceleration at the cost of some more noise
+// Feed it from the control loop; addSample() has no PROS dependency.
+class VelocityEstimator {
+public:
+	enum class Method { SLOPE, SAVITZKY_GOLAY };
+
+	static constexpr int MAX_WINDOW = 16;
+	// readings further apart than this (e.g. an unplugged motor) start a new window
+	static constexpr uint32_t MAX_GAP_MS = 100;
+
+	// window: readings to fit over, 2 to MAX_WINDOW (3 or more for SAVITZKY_GOLAY)
+	VelocityEstimator(double countsPerRev, int window = 5, Method method = Method::SLOPE);
+
+	// raw encoder counts per motor turn for a cartridge
+	static double rawCountsPerRev(pros::motor_gearset_e_t gearset);
+	// for when the cartridge is only known once the motor is plugged in;
+	// takes effect from the next reading
+	void setCountsPerRev(double countsPerRev) { this->countsPerRev = countsPerRev; }
+
+	// read the motor's raw position and timestamp; returns true if the
+	// reading was new
+	bool update(const pros::Motor& motor);
+	// same with values already read, timestamp in milliseconds
+	bool addSample(int32_t counts, uint32_t timestamp);
+
+	void reset();
+
+	// rpm, 0 until the window has two readings
+	double getVelocity() const { return velocity; }
+	// rpm per second
+	double getAcceleration() const { return acceleration; }
+	// timestamp of the newest reading
+	uint32_t getTimestamp() const { return count ? times[newest()] : 0; }
+
+private:
+	int newest() const { return (head + MAX_WINDOW - 1) % MAX_WINDOW; }
+	// reading i of the window, oldest first, as seconds and counts relative
+	// to the newest reading so the sums stay small
+	void sample(int i, double& t, double& p) const;
+	void fitLine();
+	void fitQuadratic();
+
+	double countsPerRev;
+	int window;
+	Method method;
+
+	// ring of the last readings
+	int32_t counts[MAX_WINDOW] = {};
+	uint32_t times[MAX_WINDOW] = {};
+	int head = 0;
+	int count = 0;
+
+	double velocity = 0;
+	double acceleration = 0;
+};
+
+#endif
@@ -64,6 +64,7 @@
 #include "okapi/api/control/util/flywheelSimulator.hpp"
 #include "okapi/api/control/util/pidTuner.hpp"
 #include "okapi/api/control/util/settledUtil.hpp"
+#include "okapi/api/control/util/windowedSettledUtil.hpp"
 #include "okapi/impl/control/async/asyncMotionProfileControllerBuilder.hpp"
 #include "okapi/impl/control/async/asyncPosControllerBuilder.hpp"
 #include "okapi/impl/control/async/asyncVelControllerBuilder.hpp"
@@ -99,9 +100,13 @@
 #include "okapi/api/filter/ekfFilter.hpp"
 #include "okapi/api/filter/emaFilter.hpp"
 #include "okapi/api/filter/filter.hpp"
+#include "okapi/api/filter/filterBank.hpp"
+#include "okapi/api/filter/filterChain.hpp"
 #include "okapi/api/filter/filteredControllerInput.hpp"
+#include "okapi/api/filter/kalmanFilter.hpp"
 #include "okapi/api/filter/medianFilter.hpp"
 #include "okapi/api/filter/passthroughFilter.hpp"
+#include "okapi/api/filter/runningAverageFilter.hpp"
 #include "okapi/api/filter/velMath.hpp"
 #include "okapi/impl/filter/velMathFactory.hpp"
 
@@ -126,6 +131,7 @@
 #include "okapi/api/util/abstractRate.hpp"
 #include "okapi/api/util/abstractTimer.hpp"
 #include "okapi/api/util/mathUtil.hpp"
+#include "okapi/api/util/matrix.hpp"
 #include "okapi/api/util/supplier.hpp"
 #include "okapi/api/util/timeUtil.hpp"
 #include "okapi/impl/util/configurableTimeUtilFactory.hpp"
@@ -0,0 +1,300 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/util/settledUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace okapi {
+/**
+ * The error samples of the last few moments of a control loop and the tests that decide whether
+ * it has settled. Instead of requiring every sample to stay in a band for a dwell time, the
+ * window is judged as a whole:
+ *
+ *  - the RMS error over the window, and the newest error, are within the band
+ *  - the spread between the largest and smallest error (peak to peak) is small, so an
+ *    oscillation around the target does not count as settled
+ *  - the least squares slope of the error (its trend) is small, so a slow creep does not either
+ *
+ * That needs a full window of good samples. The loop can also settle early, as soon as the error
+ * is in the band: the window fits an exponential decay to the error's magnitude and raises it
+ * until every sample lies under it. If that envelope is shrinking and already inside the band,
+ * the error cannot leave the band without the loop being disturbed, so waiting for a full window
+ * only costs time. The fit is only trusted when the samples follow it, none within a factor of
+ * ENVELOPE_FIT of the curve, and all have the same sign; an oscillation passing through zero
+ * looks like a fast decay until it swings back.
+ *
+ * Samples live in a fixed ring and nothing allocates. A window longer than MAX_SAMPLES samples
+ * only looks at the newest MAX_SAMPLES.
+ */
+class SettleWindow {
+  public:
+  static constexpr std::size_t MAX_SAMPLES = 64;
+  /**
+   * Samples needed before the decay envelope is trusted.
+   */
+  static constexpr std::size_t MIN_PREDICT_SAMPLES = 5;
+  /**
+   * How far, as a ratio, a sample may be from the fitted decay for the envelope to be trusted.
+   */
+  static constexpr double ENVELOPE_FIT = 1.5;
+
+  struct Limits {
+    double error;      // largest RMS error over the window, and largest newest error
+    double peakToPeak; // largest spread between the window's largest and smallest error
+    double trend;      // largest slope of the error, error units per second
+    double time;       // seconds the window has to span
+  };
+
+  /**
+   * @param ilimits what counts as settled
+   */
+  explicit SettleWindow(const Limits &ilimits) : limits(ilimits) {
+  }
+
+  /**
+   * Adds a sample and evaluates the window.
+   *
+   * @param itime the sample's time in seconds, increasing
+   * @param ierror the error
+   * @return whether the loop is settled
+   */
+  bool add(const double itime, const double ierror) {
+    const std::size_t slot = (oldest + count) % MAX_SAMPLES;
+    times[slot] = itime;
+    errors[slot] = ierror;
+    if (count < MAX_SAMPLES) {
+      count++;
+    } else {
+      oldest = (oldest + 1) % MAX_SAMPLES;
+    }
+    // keep one sample at or before the start of the window so a full window spans the time
+    while (count > 1 && times[(oldest + 1) % MAX_SAMPLES] <= itime - limits.time) {
+      oldest = (oldest + 1) % MAX_SAMPLES;
+      count--;
+    }
+
+    evaluate(itime, ierror);
+    return settled;
+  }
+
+  /**
+   * Clears the window.
+   */
+  void reset() {
+    oldest = 0;
+    count = 0;
+    rms = peakToPeak = trend = 0;
+    settled = predicted = false;
+  }
+
+  /**
+   * @return whether the last sample found the loop settled
+   */
+  bool isSettled() const {
+    return settled;
+  }
+
+  /**
+   * @return whether it settled on the decay envelope rather than on a full window
+   */
+  bool isPredicted() const {
+    return predicted;
+  }
+
+  double getRms() const {
+    return rms;
+  }
+
+  double getPeakToPeak() const {
+    return peakToPeak;
+  }
+
+  /**
+   * @return the error's least squares slope over the window, per second
+   */
+  double getTrend() const {
+    return trend;
+  }
+
+  const Limits &getLimits() const {
+    return limits;
+  }
+
+  protected:
+  double sampleTime(const std::size_t i) const {
+    return times[(oldest + i) % MAX_SAMPLES];
+  }
+
+  double sampleError(const std::size_t i) const {
+    return errors[(oldest + i) % MAX_SAMPLES];
+  }
+
+  void evaluate(const double itime, const double ierror) {
+    double meanT = 0;
+    double meanE = 0;
+    double sumSquares = 0;
+    double lowest = ierror;
+    double highest = ierror;
+    for (std::size_t i = 0; i < count; i++) {
+      const double e = sampleError(i);
+      meanT += sampleTime(i);
+      meanE += e;
+      sumSquares += e * e;
+      lowest = std::min(lowest, e);
+      highest = std::max(highest, e);
+    }
+    meanT /= count;
+    meanE /= count;
+    rms = std::sqrt(sumSquares / count);
+    peakToPeak = highest - lowest;
+
+    double stt = 0;
+    double ste = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      const double u = sampleTime(i) - meanT;
+      stt += u * u;
+      ste += u * (sampleError(i) - meanE);
+    }
+    trend = stt > 0 ? ste / stt : 0;
+
+    const bool within = std::fabs(ierror) <= limits.error && std::fabs(trend) <= limits.trend;
+    const bool spanned =
+      count == MAX_SAMPLES || itime - sampleTime(0) >= limits.time * (1 - 1e-9);
+    const bool full =
+      within && spanned && rms <= limits.error && peakToPeak <= limits.peakToPeak;
+    predicted = within && !full && envelopeInside(itime, ierror, meanT);
+    settled = full || predicted;
+  }
+
+  /**
+   * Fits log |error| = a + b * (t - meanT) and raises it by the largest residual, so every
+   * sample is under the envelope; true if the samples follow the decay and the envelope is
+   * inside the band now.
+   */
+  bool envelopeInside(const double itime, const double ierror, const double imeanT) const {
+    if (count < MIN_PREDICT_SAMPLES) {
+      return false;
+    }
+    for (std::size_t i = 0; i < count; i++) {
+      if ((sampleError(i) > 0) != (ierror > 0)) {
+        return false;
+      }
+    }
+    // an error of exactly 0 would pull the fit to minus infinity
+    const double floor = std::max(limits.error * 1e-3, 1e-12);
+    double meanLog = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      meanLog += std::log(std::max(std::fabs(sampleError(i)), floor));
+    }
+    meanLog /= count;
+    double stt = 0;
+    double stl = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      const double u = sampleTime(i) - imeanT;
+      stt += u * u;
+      stl += u * (std::log(std::max(std::fabs(sampleError(i)), floor)) - meanLog);
+    }
+    if (stt <= 0) {
+      return false;
+    }
+    const double rate = stl / stt;
+    if (rate >= 0) {
+      return false;
+    }
+    const double tolerance = std::log(ENVELOPE_FIT);
+    double residual = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      const double fit = meanLog + rate * (sampleTime(i) - imeanT);
+      const double r = std::log(std::max(std::fabs(sampleError(i)), floor)) - fit;
+      if (std::fabs(r) > tolerance) {
+        return false;
+      }
+      residual = std::max(residual, r);
+    }
+    const double bound = std::exp(meanLog + rate * (itime - imeanT) + residual);
+    // the error only shrinks towards 0 from here, so it spreads by at most the bound
+    return bound <= limits.error && bound <= limits.peakToPeak;
+  }
+
+  Limits limits;
+  double times[MAX_SAMPLES]{};
+  double errors[MAX_SAMPLES]{};
+  std::size_t oldest{0};
+  std::size_t count{0};
+  double rms{0};
+  double peakToPeak{0};
+  double trend{0};
+  bool settled{false};
+  bool predicted{false};
+};
+
+/**
+ * A SettledUtil that judges a window of errors with a SettleWindow instead of checking each error
+ * and its change from the last one. It is a drop-in replacement wherever a SettledUtil is
+ * supplied, for example through TimeUtil:
+ *
+ *   TimeUtil(timerSupplier, rateSupplier, Supplier<std::unique_ptr<SettledUtil>>([] {
+ *     return std::make_unique<WindowedSettledUtil>(std::make_unique<Timer>(), 20, 2, 200_ms);
+ *   }));
+ *
+ * Sample times come from the timer, so the window works at any loop rate.
+ */
+class WindowedSettledUtil : public SettledUtil {
+  public:
+  /**
+   * @param iatTargetTimer A timer used to time the samples.
+   * @param iatTargetError The largest RMS error over the window, and the largest current error.
+   * @param iatTargetDerivative The largest trend of the error per 10 ms, okapi's usual loop
+   * period, so it means what SettledUtil's change per call does at that rate.
+   * @param iatTargetTime The time the window spans, unless the decay envelope settles it early.
+   * @param iatTargetPeakToPeak The largest spread of the errors in the window, `iatTargetError` if
+   * negative. Noise fits in that easily, but a swing through the target does not.
+   */
+  explicit WindowedSettledUtil(std::unique_ptr<AbstractTimer> iatTargetTimer,
+                               const double iatTargetError = 50,
+                               const double iatTargetDerivative = 5,
+                               const QTime iatTargetTime = 250_ms,
+                               const double iatTargetPeakToPeak = -1)
+    : SettledUtil(std::move(iatTargetTimer), iatTargetError, iatTargetDerivative, iatTargetTime),
+      window({iatTargetError,
+              iatTargetPeakToPeak < 0 ? iatTargetError : iatTargetPeakToPeak,
+              iatTargetDerivative / 0.01,
+              iatTargetTime.convert(second)}) {
+  }
+
+  /**
+   * Returns whether the controller is settled.
+   *
+   * @param ierror The current error.
+   * @return Whether the controller is settled.
+   */
+  bool isSettled(const double ierror) override {
+    lastError = ierror;
+    return window.add(atTargetTimer->millis().convert(second), ierror);
+  }
+
+  /**
+   * Clears the window and the previous error.
+   */
+  void reset() override {
+    SettledUtil::reset();
+    window.reset();
+  }
+
+  /**
+   * @return the window, for its statistics
+   */
+  const SettleWindow &getWindow() const {
+    return window;
+  }
+
+  protected:
+  SettleWindow window;
+};
+} // namespace okapi
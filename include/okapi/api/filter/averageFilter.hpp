@@ -42,6 +42,29 @@ template <std::size_t n> class AverageFilter : public Filter {
     return output;
   }
 
+  /**
+   * Filters a block of values, like a recorded log, with the same results as calling filter() on
+   * each in turn. ioutput may be iinput.
+   *
+   * @param iinput measurements
+   * @param ioutput filtered results, icount of them
+   * @param icount number of measurements
+   */
+  void filter(const double *iinput, double *ioutput, const std::size_t icount) {
+    for (std::size_t i = 0; i < icount; i++) {
+      data[index++] = iinput[i];
+      if (index >= n) {
+        index = 0;
+      }
+
+      double sum = 0.0;
+      for (size_t j = 0; j < n; j++)
+        sum += data[j];
+      output = sum / (double)n;
+      ioutput[i] = output;
+    }
+  }
+
   /**
    * Returns the previous output from filter.
    *
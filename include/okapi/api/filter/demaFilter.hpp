@@ -27,6 +27,31 @@ class DemaFilter : public Filter {
    */
   double filter(double ireading) override;
 
+  /**
+   * Filters a block of values, like a recorded log, with the same results as calling filter() on
+   * each in turn. ioutput may be iinput.
+   *
+   * @param iinput measurements
+   * @param ioutput filtered results, icount of them
+   * @param icount number of measurements
+   */
+  void filter(const double *iinput, double *ioutput, std::size_t icount) {
+    const double a = alpha;
+    const double b = beta;
+    double s = lastOutputS;
+    double t = lastOutputB;
+    for (std::size_t i = 0; i < icount; i++) {
+      const double nextS = (a * iinput[i]) + ((1.0 - a) * (s + t));
+      t = (b * (nextS - s)) + ((1.0 - b) * t);
+      s = nextS;
+      ioutput[i] = s + t;
+    }
+    if (icount > 0) {
+      outputS = lastOutputS = s;
+      outputB = lastOutputB = t;
+    }
+  }
+
   /**
    * Returns the previous output from filter.
    *
@@ -25,6 +25,27 @@ class EmaFilter : public Filter {
    */
   double filter(double ireading) override;
 
+  /**
+   * Filters a block of values, like a recorded log, with the same results as calling filter() on
+   * each in turn. ioutput may be iinput.
+   *
+   * @param iinput measurements
+   * @param ioutput filtered results, icount of them
+   * @param icount number of measurements
+   */
+  void filter(const double *iinput, double *ioutput, std::size_t icount) {
+    const double a = alpha;
+    double last = lastOutput;
+    for (std::size_t i = 0; i < icount; i++) {
+      last = a * iinput[i] + (1.0 - a) * last;
+      ioutput[i] = last;
+    }
+    if (icount > 0) {
+      output = last;
+      lastOutput = last;
+    }
+  }
+
   /**
    * Returns the previous output from filter.
    *
@@ -5,6 +5,10 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 namespace okapi {
 class Filter {
   public:
@@ -25,4 +29,35 @@ class Filter {
    */
   virtual double getOutput() const = 0;
 };
+
+template <typename F, typename = void> struct HasBlockFilter : std::false_type {};
+
+template <typename F>
+struct HasBlockFilter<F,
+                      std::void_t<decltype(std::declval<F &>().filter(std::declval<const double *>(),
+                                                                      std::declval<double *>(),
+                                                                      std::size_t()))>>
+  : std::true_type {};
+
+/**
+ * Filters a block of values with any filter, with the same results as calling filter() on each in
+ * turn. Filters with a block filter() of their own (EmaFilter, DemaFilter, AverageFilter,
+ * MedianFilter and friends) use it when called by their concrete type; anything else, including a
+ * Filter reference, falls back to one filter() call per value. ioutput may be iinput.
+ *
+ * @param ifilter the filter
+ * @param iinput measurements
+ * @param ioutput filtered results, icount of them
+ * @param icount number of measurements
+ */
+template <typename F>
+void filterBlock(F &ifilter, const double *iinput, double *ioutput, const std::size_t icount) {
+  if constexpr (HasBlockFilter<F>::value) {
+    ifilter.filter(iinput, ioutput, icount);
+  } else {
+    for (std::size_t i = 0; i < icount; i++) {
+      ioutput[i] = ifilter.filter(iinput[i]);
+    }
+  }
+}
 } // namespace okapi
@@ -0,0 +1,286 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/filter/averageFilter.hpp"
+#include "okapi/api/filter/demaFilter.hpp"
+#include "okapi/api/filter/emaFilter.hpp"
+#include "okapi/api/filter/medianFilter.hpp"
+#include <array>
+#include <cstddef>
+
+namespace okapi {
+/**
+ * Runs the same kind of filter on several signals at once, such as velocity on every drive motor.
+ * Kind is the scalar filter the bank matches: EmaFilter, DemaFilter, AverageFilter<n> or
+ * MedianFilter<n>. Each channel gives exactly the output its own scalar filter would for the same
+ * readings.
+ *
+ * Filter state is stored as structure of arrays, one array per state variable, indexed by channel.
+ * One filter() call updates every channel with no virtual calls or heap use. The per-channel loops
+ * are branch free over contiguous arrays, so GCC vectorizes them at -O3 (SSE2 on the host). Small
+ * median windows use a sorting network of min and max operations for the same reason. The V5's
+ * Cortex-A9 has no double precision NEON, so on the brain the gain comes from one call per tick
+ * and contiguous state rather than SIMD.
+ *
+ * @tparam Kind the scalar filter type
+ * @tparam Channels number of signals
+ */
+template <typename Kind, std::size_t Channels> class FilterBank;
+
+template <std::size_t Channels> class FilterBank<EmaFilter, Channels> {
+  public:
+  using Readings = std::array<double, Channels>;
+
+  /**
+   * Exponential moving average filters.
+   *
+   * @param ialpha alpha gain for every channel
+   */
+  explicit FilterBank(const double ialpha) {
+    setGains(ialpha);
+  }
+
+  /**
+   * Filters one reading per channel.
+   *
+   * @param ireadings new measurements
+   * @return filtered results
+   */
+  const Readings &filter(const Readings &ireadings) {
+    for (std::size_t i = 0; i < Channels; i++) {
+      output[i] = alpha[i] * ireadings[i] + (1.0 - alpha[i]) * output[i];
+    }
+    return output;
+  }
+
+  /**
+   * Returns the previous outputs from filter.
+   *
+   * @return the previous outputs from filter
+   */
+  const Readings &getOutput() const {
+    return output;
+  }
+
+  /**
+   * Set filter gains for every channel.
+   *
+   * @param ialpha alpha gain
+   */
+  void setGains(const double ialpha) {
+    alpha.fill(ialpha);
+  }
+
+  /**
+   * Set filter gains for one channel.
+   *
+   * @param ichannel channel index
+   * @param ialpha alpha gain
+   */
+  void setGains(const std::size_t ichannel, const double ialpha) {
+    alpha[ichannel] = ialpha;
+  }
+
+  protected:
+  Readings alpha;
+  Readings output{};
+};
+
+template <std::size_t Channels> class FilterBank<DemaFilter, Channels> {
+  public:
+  using Readings = std::array<double, Channels>;
+
+  /**
+   * Double exponential moving average filters.
+   *
+   * @param ialpha alpha gain for every channel
+   * @param ibeta beta gain for every channel
+   */
+  FilterBank(const double ialpha, const double ibeta) {
+    setGains(ialpha, ibeta);
+  }
+
+  /**
+   * Filters one reading per channel.
+   *
+   * @param ireadings new measurements
+   * @return filtered results
+   */
+  const Readings &filter(const Readings &ireadings) {
+    for (std::size_t i = 0; i < Channels; i++) {
+      const double s = (alpha[i] * ireadings[i]) + ((1.0 - alpha[i]) * (outputS[i] + outputB[i]));
+      const double b = (beta[i] * (s - outputS[i])) + ((1.0 - beta[i]) * outputB[i]);
+      outputS[i] = s;
+      outputB[i] = b;
+      output[i] = s + b;
+    }
+    return output;
+  }
+
+  /**
+   * Returns the previous outputs from filter.
+   *
+   * @return the previous outputs from filter
+   */
+  const Readings &getOutput() const {
+    return output;
+  }
+
+  /**
+   * Set filter gains for every channel.
+   *
+   * @param ialpha alpha gain
+   * @param ibeta beta gain
+   */
+  void setGains(const double ialpha, const double ibeta) {
+    alpha.fill(ialpha);
+    beta.fill(ibeta);
+  }
+
+  /**
+   * Set filter gains for one channel.
+   *
+   * @param ichannel channel index
+   * @param ialpha alpha gain
+   * @param ibeta beta gain
+   */
+  void setGains(const std::size_t ichannel, const double ialpha, const double ibeta) {
+    alpha[ichannel] = ialpha;
+    beta[ichannel] = ibeta;
+  }
+
+  protected:
+  Readings alpha;
+  Readings beta;
+  Readings outputS{};
+  Readings outputB{};
+  Readings output{};
+};
+
+template <std::size_t n, std::size_t Channels> class FilterBank<AverageFilter<n>, Channels> {
+  public:
+  using Readings = std::array<double, Channels>;
+
+  /**
+   * Averaging filters.
+   */
+  FilterBank() = default;
+
+  /**
+   * Filters one reading per channel.
+   *
+   * @param ireadings new measurements
+   * @return filtered results
+   */
+  const Readings &filter(const Readings &ireadings) {
+    data[index++] = ireadings;
+    if (index >= n) {
+      index = 0;
+    }
+
+    // same summation order as AverageFilter, one tap at a time across the channels
+    output.fill(0.0);
+    for (std::size_t tap = 0; tap < n; tap++) {
+      for (std::size_t i = 0; i < Channels; i++) {
+        output[i] += data[tap][i];
+      }
+    }
+    for (std::size_t i = 0; i < Channels; i++) {
+      output[i] /= (double)n;
+    }
+    return output;
+  }
+
+  /**
+   * Returns the previous outputs from filter.
+   *
+   * @return the previous outputs from filter
+   */
+  const Readings &getOutput() const {
+    return output;
+  }
+
+  protected:
+  std::array<Readings, n> data{}; // data[tap][channel]
+  std::size_t index = 0;
+  Readings output{};
+};
+
+template <std::size_t n, std::size_t Channels> class FilterBank<MedianFilter<n>, Channels> {
+  public:
+  using Readings = std::array<double, Channels>;
+
+  /**
+   * Median filters. Readings must not be NaN.
+   */
+  FilterBank() = default;
+
+  /**
+   * Filters one reading per channel.
+   *
+   * @param ireadings new measurements
+   * @return filtered results
+   */
+  const Readings &filter(const Readings &ireadings) {
+    if constexpr (n <= sortedTaps) {
+      data[index] = ireadings;
+      selectBySorting();
+    } else {
+      // ordering is data dependent, so each channel keeps MedianFilter's sorted window
+      for (std::size_t i = 0; i < Channels; i++) {
+        MedianFilter<n>::replaceSorted(sorted[i], data[index][i], ireadings[i]);
+        output[i] = sorted[i][middleIndex];
+      }
+      data[index] = ireadings;
+    }
+    if (++index >= n) {
+      index = 0;
+    }
+    return output;
+  }
+
+  /**
+   * Returns the previous outputs from filter.
+   *
+   * @return the previous outputs from filter
+   */
+  const Readings &getOutput() const {
+    return output;
+  }
+
+  protected:
+  // up to this many taps, sorting the whole window across the channels is cheaper than keeping a
+  // sorted window per channel
+  static constexpr std::size_t sortedTaps = 9;
+  static constexpr std::size_t middleIndex = (n & 1) ? n / 2 : n / 2 - 1;
+
+  std::array<Readings, n> data{}; // data[tap][channel]
+  std::array<std::array<double, n>, n <= sortedTaps ? 0 : Channels> sorted{};
+  std::size_t index = 0;
+  Readings output{};
+
+  /**
+   * Sorts a copy of the window in every channel at once with an odd-even transposition network:
+   * each compare-exchange is a min and a max across the channels, with no data dependent branches.
+   */
+  void selectBySorting() {
+    std::array<Readings, n> window = data;
+    for (std::size_t round = 0; round < n; round++) {
+      for (std::size_t tap = round & 1; tap + 1 < n; tap += 2) {
+        for (std::size_t i = 0; i < Channels; i++) {
+          const double a = window[tap][i];
+          const double b = window[tap + 1][i];
+          // one compare per select, which compilers turn into min and max instructions
+          window[tap][i] = b < a ? b : a;
+          window[tap + 1][i] = a < b ? b : a;
+        }
+      }
+    }
+    output = window[middleIndex];
+  }
+};
+} // namespace okapi
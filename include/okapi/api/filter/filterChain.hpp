@@ -0,0 +1,98 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/filter/filter.hpp"
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace okapi {
+/**
+ * A filter made of other filters, like ComposableFilter, with the stages fixed at compile time.
+ * The input signal is passed through each stage in sequence and the output is the output of the
+ * last stage. Stages are stored by value and called by their concrete type: no heap allocation,
+ * reference counting or virtual calls. Header-only stages such as MedianFilter and AverageFilter
+ * are inlined; stages compiled into okapilib, such as EmaFilter, become direct calls.
+ *
+ * A FilterChain is itself a Filter, so it can go anywhere a Filter is expected, for example
+ * std::make_shared<FilterChain<MedianFilter<5>, EmaFilter>>(MedianFilter<5>(), EmaFilter(0.2)).
+ *
+ * @tparam Filters the stage types, each a concrete Filter
+ */
+template <typename... Filters> class FilterChain final : public Filter {
+  public:
+  /**
+   * A filter chain of default constructed stages.
+   */
+  FilterChain() = default;
+
+  /**
+   * A filter chain of the given stages. With class template argument deduction the stage types
+   * can be left out: FilterChain chain(MedianFilter<5>(), EmaFilter(0.2));
+   *
+   * @param ifilters the stages, first to last
+   */
+  explicit FilterChain(Filters... ifilters) : stages(std::move(ifilters)...) {
+  }
+
+  /**
+   * Filters a value.
+   *
+   * @param ireading A new measurement.
+   * @return The filtered result.
+   */
+  double filter(const double ireading) override {
+    output = run(ireading, std::index_sequence_for<Filters...>());
+    return output;
+  }
+
+  /**
+   * Filters a block of values with the same results as calling filter() on each in turn, one
+   * stage at a time over the whole block. ioutput may be iinput.
+   *
+   * @param iinput measurements
+   * @param ioutput filtered results, icount of them
+   * @param icount number of measurements
+   */
+  void filter(const double *iinput, double *ioutput, const std::size_t icount) {
+    if (icount == 0) {
+      return;
+    }
+    const double *stageInput = iinput;
+    std::apply(
+      [&](auto &...istages) {
+        ((filterBlock(istages, stageInput, ioutput, icount), stageInput = ioutput), ...);
+      },
+      stages);
+    output = ioutput[icount - 1];
+  }
+
+  /**
+   * @return The previous output from filter.
+   */
+  double getOutput() const override {
+    return output;
+  }
+
+  /**
+   * @return The stage at index I, to change its gains.
+   */
+  template <std::size_t I> auto &get() {
+    return std::get<I>(stages);
+  }
+
+  protected:
+  std::tuple<Filters...> stages;
+  double output = 0;
+
+  template <std::size_t... I> double run(double ireading, std::index_sequence<I...>) {
+    // qualified calls, so a stage's virtual filter() is called directly
+    ((ireading = std::get<I>(stages).Filters::filter(ireading)), ...);
+    return ireading;
+  }
+};
+} // namespace okapi
@@ -0,0 +1,220 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/util/matrix.hpp"
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace okapi {
+/**
+ * A Kalman filter over an N dimensional state, for fusing several sensors into one estimate (the
+ * scalar EKFFilter only filters one signal). Dimensions are template parameters, so the state,
+ * covariance and every intermediate live on the stack and nothing allocates.
+ *
+ * The filter only does the linear algebra. The model around it supplies the predicted state and
+ * the Jacobians, which makes it an extended Kalman filter when the model is nonlinear:
+ *
+ *   predict(f(x, u), df/dx, Q);
+ *   update(z - h(x), dh/dx, R);
+ *
+ * The model computes the innovation z - h(x) itself, so it can wrap angles. Updates with a
+ * different measurement size M are separate template instances and may be mixed freely, for
+ * example one for wheel encoders and one for a heading sensor.
+ *
+ * @tparam N number of state variables
+ */
+template <std::size_t N> class KalmanFilter {
+  public:
+  using State = Matrix<N, 1>;
+  using Covariance = Matrix<N, N>;
+
+  /**
+   * A Kalman filter starting from an estimate and its uncertainty.
+   *
+   * @param ixHat initial state estimate
+   * @param iP covariance of the initial estimate
+   */
+  KalmanFilter(const State &ixHat, const Covariance &iP) : xHat(ixHat), P(iP) {
+  }
+
+  /**
+   * Advances the estimate one step.
+   *
+   * @param ixHat the predicted state, f(xHat, u)
+   * @param iF the Jacobian of f with respect to the state at xHat
+   * @param iQ process noise covariance for this step
+   */
+  void predict(const State &ixHat, const Matrix<N, N> &iF, const Covariance &iQ) {
+    xHat = ixHat;
+    P = iF * P * iF.transpose() + iQ;
+    symmetrize();
+  }
+
+  /**
+   * Advances the estimate one step with a linear model, xHat = F * xHat.
+   *
+   * @param iF the state transition matrix
+   * @param iQ process noise covariance for this step
+   */
+  void predict(const Matrix<N, N> &iF, const Covariance &iQ) {
+    predict(iF * xHat, iF, iQ);
+  }
+
+  /**
+   * Corrects the estimate with a measurement. A measurement whose innovation is further than igate
+   * from zero, measured as the squared Mahalanobis distance, is rejected as an outlier. For M
+   * readings with Gaussian noise, the chi-squared distribution with M degrees of freedom gives the
+   * gate; for example 11.3 rejects 1% of good 3 value readings.
+   *
+   * @param iinnovation the measurement minus the predicted measurement, z - h(xHat)
+   * @param iH the Jacobian of h with respect to the state at xHat
+   * @param iR measurement noise covariance
+   * @param igate largest squared Mahalanobis distance to accept
+   * @return whether the measurement was used
+   */
+  template <std::size_t M>
+  bool update(const Matrix<M, 1> &iinnovation,
+              const Matrix<M, N> &iH,
+              const Matrix<M, M> &iR,
+              const double igate = std::numeric_limits<double>::infinity()) {
+    const Matrix<N, M> PHt = P * iH.transpose();
+    Matrix<M, M> L = iH * PHt + iR;
+    if (!cholesky(L)) {
+      return false;
+    }
+
+    // with S = L * L^T, the squared distance y^T * S^-1 * y is the squared length of L^-1 * y
+    Matrix<M, 1> w = iinnovation;
+    forwardSubstitute(L, w);
+    double distance = 0;
+    for (std::size_t i = 0; i < M; i++) {
+      distance += w[i] * w[i];
+    }
+    if (!(distance <= igate)) {
+      return false;
+    }
+
+    // K = P * H^T * S^-1, solved as S * K^T = H * P
+    Matrix<M, N> Kt = PHt.transpose();
+    forwardSubstitute(L, Kt);
+    backSubstitute(L, Kt);
+    const Matrix<N, M> K = Kt.transpose();
+
+    xHat += K * iinnovation;
+    P -= K * PHt.transpose();
+    symmetrize();
+    return true;
+  }
+
+  /**
+   * Replaces the estimate, for example when the robot is placed at a known position.
+   *
+   * @param ixHat state estimate
+   * @param iP covariance of the estimate
+   */
+  void reset(const State &ixHat, const Covariance &iP) {
+    xHat = ixHat;
+    P = iP;
+  }
+
+  /**
+   * @return the current state estimate
+   */
+  const State &getState() const {
+    return xHat;
+  }
+
+  /**
+   * @return the covariance of the current state estimate
+   */
+  const Covariance &getCovariance() const {
+    return P;
+  }
+
+  protected:
+  State xHat;
+  Covariance P;
+
+  /**
+   * Keeps P exactly symmetric so rounding cannot make it indefinite over a long run.
+   */
+  void symmetrize() {
+    for (std::size_t r = 0; r < N; r++) {
+      for (std::size_t c = r + 1; c < N; c++) {
+        const double x = (P(r, c) + P(c, r)) / 2;
+        P(r, c) = x;
+        P(c, r) = x;
+      }
+    }
+  }
+
+  /**
+   * Replaces a symmetric matrix by the lower triangular L with L * L^T equal to it.
+   *
+   * @return false if the matrix is not positive definite
+   */
+  template <std::size_t M> static bool cholesky(Matrix<M, M> &ioS) {
+    for (std::size_t c = 0; c < M; c++) {
+      double d = ioS(c, c);
+      for (std::size_t k = 0; k < c; k++) {
+        d -= ioS(c, k) * ioS(c, k);
+      }
+      if (!(d > 0)) {
+        return false;
+      }
+      d = std::sqrt(d);
+      ioS(c, c) = d;
+      for (std::size_t r = c + 1; r < M; r++) {
+        double x = ioS(r, c);
+        for (std::size_t k = 0; k < c; k++) {
+          x -= ioS(r, k) * ioS(c, k);
+        }
+        ioS(r, c) = x / d;
+      }
+      for (std::size_t r = 0; r < c; r++) {
+        ioS(r, c) = 0;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Solves L * X = B in place for lower triangular L.
+   */
+  template <std::size_t M, std::size_t C>
+  static void forwardSubstitute(const Matrix<M, M> &iL, Matrix<M, C> &ioB) {
+    for (std::size_t r = 0; r < M; r++) {
+      for (std::size_t k = 0; k < r; k++) {
+        for (std::size_t c = 0; c < C; c++) {
+          ioB(r, c) -= iL(r, k) * ioB(k, c);
+        }
+      }
+      for (std::size_t c = 0; c < C; c++) {
+        ioB(r, c) /= iL(r, r);
+      }
+    }
+  }
+
+  /**
+   * Solves L^T * X = B in place for lower triangular L.
+   */
+  template <std::size_t M, std::size_t C>
+  static void backSubstitute(const Matrix<M, M> &iL, Matrix<M, C> &ioB) {
+    for (std::size_t r = M; r-- > 0;) {
+      for (std::size_t k = r + 1; k < M; k++) {
+        for (std::size_t c = 0; c < C; c++) {
+          ioB(r, c) -= iL(k, r) * ioB(k, c);
+        }
+      }
+      for (std::size_t c = 0; c < C; c++) {
+        ioB(r, c) /= iL(r, r);
+      }
+    }
+  }
+};
+} // namespace okapi
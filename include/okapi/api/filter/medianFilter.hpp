@@ -14,7 +14,14 @@
 
 namespace okapi {
 /**
- * A filter which returns the median value of list of values.
+ * A filter which returns the median value of list of values. For an even number of taps, the
+ * lower of the two middle values is returned.
+ *
+ * Besides the window in reading order, the filter keeps the same values sorted. Each reading
+ * replaces the oldest value in place: binary search finds both, then the values ranked between
+ * them shift over by one. That is O(n) in the worst case, a reading that jumps from one end of
+ * the window to the other, but only a few values for sensor data that changes smoothly.
+ * Readings must not be NaN.
  *
  * @tparam n number of taps in the filter
  */
@@ -30,15 +37,61 @@ template <std::size_t n> class MedianFilter : public Filter {
    * @return filtered result
    */
   double filter(const double ireading) override {
+    const double old = data[index];
     data[index++] = ireading;
     if (index >= n) {
       index = 0;
     }
 
-    output = kth_smallset();
+    replaceSorted(sorted, old, ireading);
+    output = sorted[middleIndex];
     return output;
   }
 
+  /**
+   * Filters a block of values, like a recorded log, with the same results as calling filter() on
+   * each in turn. ioutput may be iinput.
+   *
+   * @param iinput measurements
+   * @param ioutput filtered results, icount of them
+   * @param icount number of measurements
+   */
+  void filter(const double *iinput, double *ioutput, const std::size_t icount) {
+    if constexpr (n > networkTaps) {
+      for (std::size_t i = 0; i < icount; i++) {
+        ioutput[i] = MedianFilter::filter(iinput[i]);
+      }
+    } else if (icount > 0) {
+      filterByNetwork(iinput, ioutput, icount);
+    }
+  }
+
+  /**
+   * Replaces one copy of iold in a sorted window with inew, keeping the window sorted. The values
+   * ranked between the two shift by one, so this is linear in how far apart they rank.
+   *
+   * @param isorted window in ascending order, containing iold
+   * @param iold value to remove
+   * @param inew value to insert
+   */
+  static void replaceSorted(std::array<double, n> &isorted, const double iold, const double inew) {
+    const auto begin = isorted.begin();
+    const auto end = isorted.end();
+    const auto from = std::lower_bound(begin, end, iold);
+    if (iold < inew) {
+      // shift the values between iold and inew down to fill iold's slot
+      const auto to = std::lower_bound(from + 1, end, inew);
+      std::copy(from + 1, to, from);
+      *(to - 1) = inew;
+    } else if (inew < iold) {
+      const auto to = std::upper_bound(begin, from, inew);
+      std::copy_backward(to, from, from + 1);
+      *to = inew;
+    } else {
+      *from = inew;
+    }
+  }
+
   /**
    * Returns the previous output from filter.
    *
@@ -50,45 +103,69 @@ template <std::size_t n> class MedianFilter : public Filter {
 
   protected:
   std::array<double, n> data{0};
+  std::array<double, n> sorted{0}; // data in ascending order
   std::size_t index = 0;
   double output = 0;
   const size_t middleIndex;
 
+  // up to this many taps, the block filter() sorts every output's window with a branch free
+  // network instead of updating the sorted window one reading at a time
+  static constexpr std::size_t networkTaps = 9;
+  static constexpr std::size_t networkChunk = 64;
+
   /**
-   * Algorithm from N. Wirth’s book, implementation by N. Devillard.
+   * Block filter for short windows. Builds each output's window side by side for a chunk of
+   * outputs and sorts them all at once with an odd-even transposition network of min and max
+   * operations, then brings data and sorted up to date for filter().
    */
-  double kth_smallset() {
-    std::array<double, n> dataCopy = data;
-    size_t j, l, m;
-    l = 0;
-    m = n - 1;
+  void filterByNetwork(const double *iinput, double *ioutput, const std::size_t icount) {
+    // the last n - 1 readings, oldest first, then the chunk's readings
+    double history[n - 1 + networkChunk];
+    for (std::size_t i = 0; i + 1 < n; i++) {
+      history[i] = data[(index + 1 + i) % n];
+    }
 
-    while (l < m) {
-      double x = dataCopy[middleIndex];
-      size_t i = l;
-      j = m;
-      do {
-        while (dataCopy[i] < x) {
-          i++;
+    std::array<std::array<double, networkChunk>, n> windows;
+    double nth = 0; // the n-th most recent reading
+    for (std::size_t start = 0; start < icount; start += networkChunk) {
+      const std::size_t length = std::min(networkChunk, icount - start);
+      for (std::size_t i = 0; i < length; i++) {
+        history[n - 1 + i] = iinput[start + i];
+      }
+      for (std::size_t tap = 0; tap < n; tap++) {
+        for (std::size_t i = 0; i < length; i++) {
+          windows[tap][i] = history[i + tap];
         }
-        while (x < dataCopy[j]) {
-          j--;
+      }
+      for (std::size_t round = 0; round < n; round++) {
+        for (std::size_t tap = round & 1; tap + 1 < n; tap += 2) {
+          for (std::size_t i = 0; i < length; i++) {
+            const double a = windows[tap][i];
+            const double b = windows[tap + 1][i];
+            windows[tap][i] = b < a ? b : a;
+            windows[tap + 1][i] = a < b ? b : a;
+          }
         }
-        if (i <= j) {
-          const double t = dataCopy[i];
-          dataCopy[i] = dataCopy[j];
-          dataCopy[j] = t;
-          i++;
-          j--;
-        }
-      } while (i <= j);
-      if (j < middleIndex)
-        l = i;
-      if (middleIndex < i)
-        m = j;
+      }
+      for (std::size_t i = 0; i < length; i++) {
+        ioutput[start + i] = windows[middleIndex][i];
+      }
+      nth = history[length - 1];
+      for (std::size_t i = 0; i + 1 < n; i++) {
+        history[i] = history[length + i];
+      }
     }
 
-    return dataCopy[middleIndex];
+    // the ring as filter() would have left it: the oldest reading at the new index, then the
+    // rest in order
+    index = (index + icount) % n;
+    data[index] = nth;
+    for (std::size_t i = 0; i + 1 < n; i++) {
+      data[(index + 1 + i) % n] = history[i];
+    }
+    sorted = data;
+    std::sort(sorted.begin(), sorted.end());
+    output = ioutput[icount - 1];
   }
 };
 } // namespace okapi
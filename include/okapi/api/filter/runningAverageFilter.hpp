@@ -0,0 +1,102 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/filter/filter.hpp"
+#include <array>
+#include <cstddef>
+
+namespace okapi {
+/**
+ * A filter which returns the average of a list of values, like AverageFilter, but keeps a running
+ * sum of the window so each reading costs O(1) instead of O(n). Use it for long windows.
+ *
+ * The running sum uses compensated (Kahan) summation, so rounding does not build up between
+ * readings. Every time the window wraps, the sum is recomputed exactly the way AverageFilter
+ * computes it. That takes O(n) once per n readings, so it is amortized O(1), and it keeps drift
+ * from building up over a match. The output is bit-identical to AverageFilter<n> on every n-th
+ * reading. In between it differs by at most (n + 6) * DBL_EPSILON * the largest magnitude of the
+ * last 2n readings; AverageFilter's own rounding accounts for n of that. Do not build with
+ * -ffast-math, which removes the compensation.
+ *
+ * @tparam n number of taps in the filter
+ */
+template <std::size_t n> class RunningAverageFilter : public Filter {
+  public:
+  /**
+   * Running sum averaging filter.
+   */
+  RunningAverageFilter() = default;
+
+  /**
+   * Filters a value, like a sensor reading.
+   *
+   * @param ireading new measurement
+   * @return filtered result
+   */
+  double filter(const double ireading) override {
+    const double old = data[index];
+    data[index++] = ireading;
+    if (index >= n) {
+      index = 0;
+      resync();
+    } else {
+      add(ireading);
+      add(-old);
+    }
+
+    output = sum / (double)n;
+    return output;
+  }
+
+  /**
+   * Filters a block of values, like a recorded log, with the same results as calling filter() on
+   * each in turn. ioutput may be iinput.
+   *
+   * @param iinput measurements
+   * @param ioutput filtered results, icount of them
+   * @param icount number of measurements
+   */
+  void filter(const double *iinput, double *ioutput, const std::size_t icount) {
+    for (std::size_t i = 0; i < icount; i++) {
+      ioutput[i] = RunningAverageFilter::filter(iinput[i]);
+    }
+  }
+
+  /**
+   * Returns the previous output from filter.
+   *
+   * @return the previous output from filter
+   */
+  double getOutput() const override {
+    return output;
+  }
+
+  protected:
+  std::array<double, n> data{0};
+  std::size_t index = 0;
+  double sum = 0;
+  double compensation = 0; // low order bits lost from sum
+  double output = 0;
+
+  void add(const double x) {
+    const double y = x - compensation;
+    const double t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+  }
+
+  /**
+   * Recomputes the sum in the same order as AverageFilter.
+   */
+  void resync() {
+    sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+      sum += data[i];
+    compensation = 0;
+  }
+};
+} // namespace okapi
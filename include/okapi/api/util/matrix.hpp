@@ -0,0 +1,133 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace okapi {
+/**
+ * A dense matrix of doubles with its size fixed at compile time, stored row major in the object
+ * itself. Nothing here allocates, so it is safe to use in control loops. Sizes are meant to be
+ * small (a Kalman filter's state); every loop has a constant trip count, so the compiler can unroll
+ * them.
+ *
+ * @tparam Rows number of rows
+ * @tparam Cols number of columns
+ */
+template <std::size_t Rows, std::size_t Cols> class Matrix {
+  public:
+  /**
+   * A matrix of zeros.
+   */
+  Matrix() = default;
+
+  /**
+   * @return the identity matrix
+   */
+  static Matrix identity() {
+    static_assert(Rows == Cols, "only square matrices have an identity");
+    Matrix m;
+    for (std::size_t i = 0; i < Rows; i++) {
+      m(i, i) = 1;
+    }
+    return m;
+  }
+
+  /**
+   * @return a square matrix with idiagonal on its diagonal
+   */
+  static Matrix diagonal(const std::array<double, Rows> &idiagonal) {
+    static_assert(Rows == Cols, "only square matrices have a diagonal");
+    Matrix m;
+    for (std::size_t i = 0; i < Rows; i++) {
+      m(i, i) = idiagonal[i];
+    }
+    return m;
+  }
+
+  double &operator()(const std::size_t irow, const std::size_t icol) {
+    return data[irow * Cols + icol];
+  }
+
+  double operator()(const std::size_t irow, const std::size_t icol) const {
+    return data[irow * Cols + icol];
+  }
+
+  /**
+   * Element of a column vector.
+   */
+  double &operator[](const std::size_t irow) {
+    static_assert(Cols == 1, "only column vectors have one index");
+    return data[irow];
+  }
+
+  double operator[](const std::size_t irow) const {
+    static_assert(Cols == 1, "only column vectors have one index");
+    return data[irow];
+  }
+
+  Matrix<Cols, Rows> transpose() const {
+    Matrix<Cols, Rows> m;
+    for (std::size_t r = 0; r < Rows; r++) {
+      for (std::size_t c = 0; c < Cols; c++) {
+        m(c, r) = (*this)(r, c);
+      }
+    }
+    return m;
+  }
+
+  Matrix &operator+=(const Matrix &rhs) {
+    for (std::size_t i = 0; i < Rows * Cols; i++) {
+      data[i] += rhs.data[i];
+    }
+    return *this;
+  }
+
+  Matrix &operator-=(const Matrix &rhs) {
+    for (std::size_t i = 0; i < Rows * Cols; i++) {
+      data[i] -= rhs.data[i];
+    }
+    return *this;
+  }
+
+  Matrix &operator*=(const double rhs) {
+    for (double &x : data) {
+      x *= rhs;
+    }
+    return *this;
+  }
+
+  friend Matrix operator+(Matrix lhs, const Matrix &rhs) {
+    return lhs += rhs;
+  }
+
+  friend Matrix operator-(Matrix lhs, const Matrix &rhs) {
+    return lhs -= rhs;
+  }
+
+  friend Matrix operator*(Matrix lhs, const double rhs) {
+    return lhs *= rhs;
+  }
+
+  protected:
+  std::array<double, Rows * Cols> data{};
+};
+
+template <std::size_t Rows, std::size_t Inner, std::size_t Cols>
+Matrix<Rows, Cols> operator*(const Matrix<Rows, Inner> &lhs, const Matrix<Inner, Cols> &rhs) {
+  Matrix<Rows, Cols> m;
+  for (std::size_t r = 0; r < Rows; r++) {
+    for (std::size_t k = 0; k < Inner; k++) {
+      const double x = lhs(r, k);
+      for (std::size_t c = 0; c < Cols; c++) {
+        m(r, c) += x * rhs(k, c);
+      }
+    }
+  }
+  return m;
+}
+} // namespace okapi
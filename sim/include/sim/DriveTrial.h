@@ -0,0 +1,44 @@
+#ifndef SIM_DRIVE_TRIAL_H
+#define SIM_DRIVE_TRIAL_H
+
+#include "sim/DrivetrainSimulator.h"
+
+#include <functional>
+
+namespace sim {
+
+// A straight drive move with a controller in the loop, on a World of its
+// own that is stepped directly instead of through the virtual clock. Trials
+// do not depend on the global simulation or on each other, so tools can run
+// many of them on several threads at once.
+class DriveTrial {
+public:
+	// called every control period with the seconds since the start, the
+	// distance driven (inches, average of both sides' encoders), the speed
+	// (in/s) and the battery (mV); returns millivolts for both sides
+	using Controller = std::function<double(double t, double position, double velocity, double battery)>;
+
+	struct Result {
+		double itae;       // integral of time * |target - position|, inch seconds^2
+		double overshoot;  // inches past the target, 0 if it never got there
+		double settleTime; // seconds until it stayed within tolerance, the duration if it never did
+		double finalError; // inches
+		bool settled;      // within tolerance and nearly stopped at the end
+	};
+
+	// latencyMs: how old the readings the controller gets are. The real
+	// brain hears from a motor every 10 ms and the command it sends back
+	// takes effect up to a frame later; 0 reads the plant directly.
+	explicit DriveTrial(const DrivetrainSimulator::Config& config, uint32_t periodMs = 10, uint32_t latencyMs = 0);
+
+	Result run(double distance, const Controller& controller, double duration, double tolerance = 0.5);
+
+private:
+	DrivetrainSimulator::Config config;
+	uint32_t periodMs;
+	uint32_t latencyMs;
+};
+
+} // namespace sim
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef SIM_DRIVETRAIN_SIMULATOR_H
+#define SIM_DRIVETRAIN_SIMULATOR_H
+
+#include "sim/Sim.h"
+
+#include <mutex>
+#include <vector>
+
+namespace sim {
+
+// A V5 motor at its output shaft: a DC motor behind the cartridge whose
+// current the firmware limits
+struct MotorModel {
+	double stallTorque; // Nm at the 2.5 A current limit
+	double freeSpeed;   // rpm at 12 V
+	double resistance;  // ohms
+
+	static MotorModel forGearset(int gearset);
+
+	// Torque in Nm for a terminal voltage (V) at a speed (rpm), with the
+	// current (A) limited to currentLimit. A coasting motor is open circuit.
+	double torque(double voltage, double rpm, double currentLimit, bool coast, double* current) const;
+};
+
+// Skid steer drivetrain on a flat field. Each side's motors drive one
+// geared wheel train; the wheels push the body through tire friction, so a
+// side can spin out, and turning drags the end wheels sideways (scrub).
+// Motors not on the drivetrain keep the free motor model. Every connected
+// IMU rides on the body. Battery sag from the total current draw caps the
+// voltage all motors get and shows up in battery_get_voltage().
+//
+// Geometry is in inches like the robot code; everything else is SI.
+class DrivetrainSimulator : public Plant {
+public:
+	struct Mount {
+		uint8_t port;
+		bool reversed;        // motor spins backwards to drive its side forward
+		double strength = 1;  // torque scale for a worn or strong motor
+	};
+
+	// x to the right and y forward at heading 0, heading in degrees
+	// clockwise like the IMU's rotation
+	struct Pose {
+		double x;
+		double y;
+		double heading;
+	};
+
+	struct Config {
+		std::vector<Mount> left;
+		std::vector<Mount> right;
+		int cartridge = 2;               // pros::motor_gearset_e_t installed in the drive motors
+		double gearRatio = 1;            // wheel turns per motor turn
+		double wheelDiameter = 4;        // in
+		double trackWidth = 12;          // in, left to right wheel contact
+		double wheelbase = 10;           // in, front to back wheel
+		double mass = 6.5;               // kg
+		double inertia = 0;              // kg m^2 about the center, 0 estimates a uniform box
+		double sideInertia = 0.4;        // kg, a side's wheels, gears and rotors seen at the tread
+		double traction = 1.0;           // tire friction coefficient
+		double scrub = 0.3;              // sideways friction of the end wheels, low for omnis
+		double slipSpeed = 0.05;         // m/s of slip where friction saturates
+		double rollingResistance = 3;    // N per side
+		double batteryVoltage = 12.8;    // V, open circuit
+		double batteryResistance = 0.08; // ohms
+		double maxStep = 0.00025;        // s, each world step is split into steps this short
+		Pose start = {0, 0, 0};
+	};
+
+	explicit DrivetrainSimulator(const Config& config);
+
+	// puts the drive's cartridges into world's motors, call before stepping it
+	void install(World& world) const;
+
+	void step(World& world, double dt) override;
+
+	Pose getPose() const;
+	void setPose(const Pose& pose); // also stops the robot
+	double getVelocity() const;        // in/s forward
+	double getAngularVelocity() const; // deg/s clockwise
+	const Config& getConfig() const;
+
+private:
+	struct Side {
+		std::vector<Mount> motors;
+		double wheelSpeed = 0; // m/s at the tread
+	};
+
+	void substep(World& world, double dt, double supplyVoltage);
+	double sideForce(World& world, Side& side, double supplyVoltage, double groundSpeed, double dt);
+
+	// guards the state below against readers on other threads; the world's
+	// lock is not enough, a DriveTrial steps a World of its own
+	mutable std::mutex mutex;
+	Config config;
+	MotorModel model;
+	double wheelRadius; // m
+	double inertia;
+	double current = 0; // A drawn from the battery last step
+
+	Side left;
+	Side right;
+	double x = 0; // m
+	double y = 0;
+	double heading = 0; // rad clockwise
+	double velocity = 0;        // m/s forward
+	double angularVelocity = 0; // rad/s clockwise
+	double acceleration = 0;    // m/s^2 forward
+};
+
+// The drivetrain in RobotSpecifics.h, with estimates for what it doesn't say
+DrivetrainSimulator::Config robotDrivetrain();
+
+} // namespace sim
+
+#endif
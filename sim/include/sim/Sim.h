@@ -0,0 +1,173 @@
+#ifndef SIM_SIM_H
+#define SIM_SIM_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Host-side stand-in for the V5 brain.
+// The PROS API implemented in sim/src reads and writes a single World; a
+// pluggable Plant advances the physics behind it. Host tools set up the
+// world (plant, controller input, competition state) and then call the
+// normal robot entry points from src/main.cpp.
+namespace sim {
+
+constexpr int NUM_PORTS = 21;
+constexpr int NUM_ADI = 8;
+constexpr int NUM_CONTROLLERS = 2;
+constexpr int NUM_ANALOG = 4;
+constexpr int NUM_DIGITAL = 12;   // L1 through A, in pros::controller_digital_e_t order
+constexpr int FIRST_DIGITAL = 6;  // pros::E_CONTROLLER_DIGITAL_L1
+constexpr int LCD_LINES = 8;
+constexpr int LCD_LINE_LENGTH = 64;
+
+// COMPETITION_DISABLED from pros/misc.h
+constexpr uint8_t COMPETITION_DISABLED_BIT = 1 << 0;
+
+// How often the motor and IMU readings visible to user code refresh, like
+// the real smart port update rate
+constexpr uint32_t DEVICE_UPDATE_MS = 10;
+
+struct MotorState {
+	enum class Mode { VOLTAGE, VELOCITY, POSITION, BRAKE };
+
+	bool connected = false;
+
+	// configuration
+	bool reversed = false;
+	int gearset = 1;        // pros::motor_gearset_e_t the code configured
+	int cartridge = -1;     // gearset physically installed, -1 when it matches
+	int encoderUnits = 0;   // pros::motor_encoder_units_e_t
+	int brakeMode = 0;      // pros::motor_brake_mode_e_t
+	int32_t currentLimit = 2500;
+	int32_t voltageLimit = 0; // 0 means none
+
+	// command, in the motor's physical direction (reversal already applied)
+	Mode mode = Mode::VOLTAGE;
+	int32_t targetVoltage = 0;  // mV
+	double targetVelocity = 0;  // rpm
+	double targetPosition = 0;  // degrees
+
+	// physical state written by the plant, output shaft degrees and rpm
+	double position = 0;
+	double velocity = 0;
+	double current = 0;       // mA
+	double torque = 0;        // Nm
+	double appliedVoltage = 0; // mV
+	double temperature = 25;
+
+	// what the brain last received from the motor
+	double reportedPosition = 0;
+	double reportedVelocity = 0;
+	double reportedCurrent = 0;
+	double reportedTorque = 0;
+	double reportedVoltage = 0;
+	uint32_t reportedTimestamp = 0;
+
+	double zeroPosition = 0; // reported degrees, after reversal, that read as zero
+};
+
+struct ImuState {
+	bool connected = false;
+	uint32_t calibratedAt = 0; // ms, readings are invalid before this
+
+	// physical state written by the plant
+	double rotation = 0;  // degrees, clockwise positive, unbounded
+	double rate = 0;      // degrees per second, clockwise positive
+	double pitch = 0;
+	double roll = 0;
+	double accel[3] = {0, 0, 1};
+	double drift = 0; // deg/s of gyro bias, accumulates in the readings
+
+	double reportedRotation = 0;
+	double reportedRate = 0;
+
+	double rotationOffset = 0; // set_rotation/tare bookkeeping
+	double headingOffset = 0;
+};
+
+struct ControllerState {
+	bool connected = true;
+	int32_t analog[NUM_ANALOG] = {};
+	bool digital[NUM_DIGITAL] = {};
+	bool newPress[NUM_DIGITAL] = {};
+};
+
+struct World {
+	double time = 0; // seconds of simulated physics
+	MotorState motors[NUM_PORTS + 1];
+	ImuState imus[NUM_PORTS + 1];
+	ControllerState controllers[NUM_CONTROLLERS];
+	int32_t adi[NUM_ADI + 1] = {};
+	char lcd[LCD_LINES][LCD_LINE_LENGTH] = {};
+	uint8_t competitionStatus = 0;
+	int32_t batteryVoltage = 12800; // mV
+	bool usdInstalled = false;
+	uint32_t imuCalibrationMs = 2000;
+	bool printLcd = false;
+};
+
+// Physics behind the ports. step() reads each motor's command (see
+// commandedVoltage) and writes position, velocity and current back, and
+// updates any IMU the plant knows about.
+class Plant {
+public:
+	virtual ~Plant() = default;
+	virtual void step(World& world, double dt) = 0;
+};
+
+// Every connected motor spins freely with a first order response; IMUs stay
+// still. The default plant.
+class FreeMotorPlant : public Plant {
+public:
+	void step(World& world, double dt) override;
+
+	// advance one connected motor of world
+	static void stepMotor(const World& world, MotorState& motor, double dt);
+};
+
+// The world and the lock every API call takes
+World& world();
+std::recursive_mutex& worldMutex();
+
+void setPlant(std::shared_ptr<Plant> plant);
+
+// voltage the motor's firmware would apply for its current command, in mV;
+// zero while the competition status of world, the motor's, is disabled
+double commandedVoltage(const World& world, const MotorState& motor);
+double maxRpm(int gearset);
+double countsPerRev(int gearset);
+int cartridgeOf(const MotorState& motor);
+
+// Simulated time in microseconds, shared by pros::millis/micros, delays and
+// okapi's timers. It is virtual: tasks run one at a time and the clock only
+// moves when every task is blocked, jumping to the next wake up and stepping
+// the plant on the way. A run is deterministic and as fast as the host allows.
+uint64_t micros();
+
+// Start the simulation, call once before initialize(). The calling thread is
+// already the first task. realTime paces the clock to the wall clock, for
+// watching a run.
+void start(bool realTime = false);
+
+// Step the plant in 1 ms ticks up to time, reporting device readings every
+// DEVICE_UPDATE_MS. Called by the scheduler as the clock advances.
+void advancePhysics(uint64_t time);
+
+// controller input helpers (the same ids and enums as PROS)
+void setAnalog(int controller, int channel, int32_t value);
+void setDigital(int controller, int button, bool pressed);
+
+// Load readings as the API reports them (raw counts, rpm, mA, mV; degrees
+// and the gyro's z rate) into a motor or IMU, physical and reported state
+// both, for replaying recorded sensors. Pair with a plant that leaves
+// them alone.
+void setMotorReading(int port, int32_t rawPosition, double velocity, double current, double voltage);
+void setImuReading(int port, double rotation, double gyroZ);
+
+// run an LLEMU button callback (0 left, 1 center, 2 right)
+void pressLcdButton(int button);
+
+} // namespace sim
+
+#endif
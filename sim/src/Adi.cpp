@@ -0,0 +1,117 @@
+// The parts of pros/adi.h and pros/adi.hpp the robot uses: raw ports and
+// digital in/out (pneumatics). Values live in World::adi.
+#include "api.h"
+#include "sim/Sim.h"
+
+#include <cerrno>
+
+namespace {
+
+pros::adi_port_config_e_t configs[sim::NUM_ADI + 1];
+bool new_press_armed[sim::NUM_ADI + 1];
+
+// 'A'-'H', 'a'-'h' or 1-8 to 1-8, 0 when invalid
+uint8_t to_port(uint8_t port) {
+	if (port >= 'a' && port <= 'h') {
+		port -= 'a' - 1;
+	} else if (port >= 'A' && port <= 'H') {
+		port -= 'A' - 1;
+	}
+	if (port < 1 || port > sim::NUM_ADI) {
+		errno = ENXIO;
+		return 0;
+	}
+	return port;
+}
+
+} // namespace
+
+namespace pros {
+namespace c {
+
+adi_port_config_e_t adi_port_get_config(uint8_t port) {
+	port = to_port(port);
+	return port ? configs[port] : E_ADI_ERR;
+}
+
+int32_t adi_port_get_value(uint8_t port) {
+	port = to_port(port);
+	if (!port) {
+		return PROS_ERR;
+	}
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	return sim::world().adi[port];
+}
+
+int32_t adi_port_set_config(uint8_t port, adi_port_config_e_t type) {
+	port = to_port(port);
+	if (!port) {
+		return PROS_ERR;
+	}
+	configs[port] = type;
+	return 1;
+}
+
+int32_t adi_port_set_value(uint8_t port, int32_t value) {
+	port = to_port(port);
+	if (!port) {
+		return PROS_ERR;
+	}
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	sim::world().adi[port] = value;
+	return 1;
+}
+
+int32_t adi_digital_read(uint8_t port) {
+	int32_t value = adi_port_get_value(port);
+	return value == PROS_ERR ? PROS_ERR : value != 0;
+}
+
+int32_t adi_digital_get_new_press(uint8_t port) {
+	int32_t pressed = adi_digital_read(port);
+	if (pressed == PROS_ERR) {
+		return PROS_ERR;
+	}
+	port = to_port(port);
+	bool newPress = pressed && !new_press_armed[port];
+	new_press_armed[port] = pressed;
+	return newPress;
+}
+
+int32_t adi_digital_write(uint8_t port, bool value) {
+	return adi_port_set_value(port, value);
+}
+
+} // namespace c
+
+ADIPort::ADIPort(std::uint8_t adi_port, adi_port_config_e_t type) : _smart_port(INTERNAL_ADI_PORT), _adi_port(adi_port) {
+	c::adi_port_set_config(_adi_port, type);
+}
+
+std::int32_t ADIPort::get_config() const {
+	return c::adi_port_get_config(_adi_port);
+}
+
+std::int32_t ADIPort::get_value() const {
+	return c::adi_port_get_value(_adi_port);
+}
+
+std::int32_t ADIPort::set_config(adi_port_config_e_t type) const {
+	return c::adi_port_set_config(_adi_port, type);
+}
+
+std::int32_t ADIPort::set_value(std::int32_t value) const {
+	return c::adi_port_set_value(_adi_port, value);
+}
+
+ADIDigitalOut::ADIDigitalOut(std::uint8_t adi_port, bool init_state) : ADIPort(adi_port, E_ADI_DIGITAL_OUT) {
+	set_value(init_state);
+}
+
+ADIDigitalIn::ADIDigitalIn(std::uint8_t adi_port) : ADIPort(adi_port, E_ADI_DIGITAL_IN) {}
+
+std::int32_t ADIDigitalIn::get_new_press() const {
+	return c::adi_digital_get_new_press(_adi_port);
+}
+
+} // namespace pros
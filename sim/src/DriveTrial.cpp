@@ -0,0 +1,77 @@
+#include "sim/DriveTrial.h"
+#include "MotionProfile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+// the robot reads its encoders and commands the motors once per control
+// period; the plant steps in 1 ms like advancePhysics
+static constexpr double PHYSICS_STEP = 0.001;
+
+DriveTrial::DriveTrial(const DrivetrainSimulator::Config& config, uint32_t periodMs, uint32_t latencyMs)
+    : config(config), periodMs(periodMs), latencyMs(latencyMs) {}
+
+DriveTrial::Result DriveTrial::run(double distance, const Controller& controller, double duration,
+                                   double tolerance) {
+	// World is large; keep it off the stack of whatever thread runs the trial
+	auto world = std::make_unique<World>();
+	DrivetrainSimulator drivetrain(config);
+	std::vector<DrivetrainSimulator::Mount> mounts = config.left;
+	mounts.insert(mounts.end(), config.right.begin(), config.right.end());
+	for (const DrivetrainSimulator::Mount& mount : mounts) {
+		world->motors[mount.port].connected = true;
+	}
+	drivetrain.install(*world);
+
+	const double inchesPerDegree = config.gearRatio * M_PI * config.wheelDiameter / 360;
+	const double dt = periodMs / 1000.0;
+	const int steps = std::max(1, (int) std::lround(dt / PHYSICS_STEP));
+
+	// position and velocity after every physics step, oldest first, for
+	// the controller to read latencyMs late
+	struct Reading {
+		double position;
+		double velocity;
+	};
+	auto read = [&] {
+		Reading reading = {0, 0};
+		for (const DrivetrainSimulator::Mount& mount : mounts) {
+			const MotorState& motor = world->motors[mount.port];
+			double sign = mount.reversed ? -1 : 1;
+			reading.position += sign * motor.position * inchesPerDegree;
+			reading.velocity += sign * motor.velocity * 6 * inchesPerDegree;
+		}
+		reading.position /= mounts.size();
+		reading.velocity /= mounts.size();
+		return reading;
+	};
+	std::vector<Reading> history = {read()};
+	const size_t lag = (size_t) std::lround(latencyMs / 1000.0 / (dt / steps));
+
+	MoveScore score(distance, tolerance);
+	for (double t = 0; t < duration; t += dt) {
+		const Reading& now = history.back();
+		score.add(t, dt, now.position, now.velocity);
+
+		const Reading& seen = history[history.size() - 1 - std::min(lag, history.size() - 1)];
+		double millivolts = controller(t, seen.position, seen.velocity, world->batteryVoltage);
+		millivolts = std::clamp(millivolts, -12000.0, 12000.0);
+		for (const DrivetrainSimulator::Mount& mount : mounts) {
+			MotorState& motor = world->motors[mount.port];
+			motor.mode = MotorState::Mode::VOLTAGE;
+			motor.targetVoltage = (int32_t) ((mount.reversed ? -1 : 1) * millivolts);
+		}
+		for (int i = 0; i < steps; i++) {
+			drivetrain.step(*world, dt / steps);
+			history.push_back(read());
+		}
+	}
+
+	return {score.getItae(), score.getOvershoot(), score.getSettleTime(), score.getError(), score.isSettled()};
+}
+
+} // namespace sim
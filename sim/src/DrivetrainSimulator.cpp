@@ -0,0 +1,200 @@
+#include "sim/DrivetrainSimulator.h"
+#include "RobotSpecifics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+static constexpr double GRAVITY = 9.81;
+static constexpr double METERS_PER_INCH = 0.0254;
+static constexpr double RPM_TO_RAD = 2 * M_PI / 60;
+static constexpr double RATED_CURRENT = 2.5; // A, the default limit the stall torques are quoted at
+static constexpr double ROLLING_SPEED = 0.01; // m/s, smooths rolling resistance through zero
+
+MotorModel MotorModel::forGearset(int gearset) {
+	// 11 W motor: 100/200/600 rpm free, torque inversely proportional
+	switch (gearset) {
+	case 0:
+		return {2.1, 100, 2.4};
+	case 2:
+		return {0.35, 600, 2.4};
+	default:
+		return {1.05, 200, 2.4};
+	}
+}
+
+double MotorModel::torque(double voltage, double rpm, double currentLimit, bool coast, double* current) const {
+	double i = 0;
+	if (!coast) {
+		double backEmf = 12 * rpm / freeSpeed;
+		i = std::clamp((voltage - backEmf) / resistance, -currentLimit, currentLimit);
+	}
+	if (current) {
+		*current = i;
+	}
+	return stallTorque / RATED_CURRENT * i;
+}
+
+DrivetrainSimulator::DrivetrainSimulator(const Config& config)
+    : config(config), model(MotorModel::forGearset(config.cartridge)) {
+	wheelRadius = config.wheelDiameter * METERS_PER_INCH / 2;
+	inertia = config.inertia;
+	if (inertia <= 0) {
+		double width = config.trackWidth * METERS_PER_INCH;
+		double length = config.wheelbase * METERS_PER_INCH;
+		inertia = config.mass * (width * width + length * length) / 12;
+	}
+	left.motors = config.left;
+	right.motors = config.right;
+	x = config.start.x * METERS_PER_INCH;
+	y = config.start.y * METERS_PER_INCH;
+	heading = config.start.heading * M_PI / 180;
+}
+
+void DrivetrainSimulator::install(World& world) const {
+	for (const Side* side : {&left, &right}) {
+		for (const Mount& mount : side->motors) {
+			world.motors[mount.port].cartridge = config.cartridge;
+		}
+	}
+}
+
+// Net force the side's tires put on the body; advances the side's wheels
+double DrivetrainSimulator::sideForce(World& world, Side& side, double supplyVoltage, double groundSpeed,
+                                      double dt) {
+	double motorRadPerMeter = 1 / (wheelRadius * config.gearRatio);
+	double drive = 0;
+	for (const Mount& mount : side.motors) {
+		MotorState& motor = world.motors[mount.port];
+		double sign = mount.reversed ? -1 : 1;
+		double rpm = sign * side.wheelSpeed * motorRadPerMeter / RPM_TO_RAD;
+		double voltage = std::clamp(commandedVoltage(world, motor) / 1000, -supplyVoltage, supplyVoltage);
+		// an unplugged or coasting motor is open circuit
+		bool coast = !motor.connected ||
+		             (voltage == 0 && motor.mode != MotorState::Mode::BRAKE && motor.brakeMode == 0);
+		double i;
+		double torque = mount.strength * model.torque(voltage, rpm, motor.currentLimit / 1000.0, coast, &i);
+		drive += sign * torque * motorRadPerMeter;
+
+		motor.velocity = rpm;
+		motor.position += rpm * 6 * dt;
+		motor.current = std::abs(i) * 1000;
+		motor.torque = torque;
+		motor.appliedVoltage = coast ? 0 : voltage * 1000;
+		current += std::abs(i);
+	}
+
+	double load = config.mass * GRAVITY / 2;
+	double slip = side.wheelSpeed - groundSpeed;
+	double traction = config.traction * load * std::tanh(slip / config.slipSpeed);
+	double rolling = config.rollingResistance * std::tanh(side.wheelSpeed / ROLLING_SPEED);
+	side.wheelSpeed += (drive - traction - rolling) / config.sideInertia * dt;
+	return traction;
+}
+
+void DrivetrainSimulator::substep(World& world, double dt, double supplyVoltage) {
+	double halfTrack = config.trackWidth * METERS_PER_INCH / 2;
+	double halfBase = config.wheelbase * METERS_PER_INCH / 2;
+
+	// clockwise rotation speeds up the left side
+	double leftForce = sideForce(world, left, supplyVoltage, velocity + angularVelocity * halfTrack, dt);
+	double rightForce = sideForce(world, right, supplyVoltage, velocity - angularVelocity * halfTrack, dt);
+
+	// half the weight on the end wheels, dragged sideways halfBase from the center
+	double scrubTorque = config.scrub * config.mass * GRAVITY / 2 * halfBase *
+	                     std::tanh(angularVelocity * halfBase / config.slipSpeed);
+
+	acceleration = (leftForce + rightForce) / config.mass;
+	velocity += acceleration * dt;
+	angularVelocity += ((leftForce - rightForce) * halfTrack - scrubTorque) / inertia * dt;
+	heading += angularVelocity * dt;
+	x += velocity * std::sin(heading) * dt;
+	y += velocity * std::cos(heading) * dt;
+}
+
+void DrivetrainSimulator::step(World& world, double dt) {
+	std::lock_guard<std::mutex> lock(mutex);
+	bool drive[NUM_PORTS + 1] = {};
+	for (Side* side : {&left, &right}) {
+		for (const Mount& mount : side->motors) {
+			drive[mount.port] = true;
+		}
+	}
+
+	double supplyVoltage = config.batteryVoltage - config.batteryResistance * current;
+	current = 0;
+	double startHeading = heading;
+	int steps = std::max(1, (int) std::ceil(dt / config.maxStep));
+	for (int i = 0; i < steps; i++) {
+		substep(world, dt / steps, supplyVoltage);
+	}
+	current /= steps;
+
+	for (int port = 1; port <= NUM_PORTS; port++) {
+		MotorState& motor = world.motors[port];
+		if (motor.connected && !drive[port]) {
+			FreeMotorPlant::stepMotor(world, motor, dt);
+			current += motor.current / 1000;
+		}
+	}
+	world.batteryVoltage = (int32_t) (supplyVoltage * 1000);
+
+	// the IMU counts rotation from wherever it powered on, not the field's heading
+	for (ImuState& imu : world.imus) {
+		imu.rotation += (heading - startHeading) * 180 / M_PI;
+		imu.rate = angularVelocity * 180 / M_PI;
+		imu.accel[1] = acceleration / GRAVITY;
+	}
+}
+
+DrivetrainSimulator::Pose DrivetrainSimulator::getPose() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return {x / METERS_PER_INCH, y / METERS_PER_INCH, heading * 180 / M_PI};
+}
+
+void DrivetrainSimulator::setPose(const Pose& pose) {
+	std::lock_guard<std::mutex> lock(mutex);
+	x = pose.x * METERS_PER_INCH;
+	y = pose.y * METERS_PER_INCH;
+	heading = pose.heading * M_PI / 180;
+	velocity = 0;
+	angularVelocity = 0;
+	acceleration = 0;
+	left.wheelSpeed = 0;
+	right.wheelSpeed = 0;
+}
+
+double DrivetrainSimulator::getVelocity() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return velocity / METERS_PER_INCH;
+}
+
+double DrivetrainSimulator::getAngularVelocity() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return angularVelocity * 180 / M_PI;
+}
+
+const DrivetrainSimulator::Config& DrivetrainSimulator::getConfig() const {
+	return config;
+}
+
+DrivetrainSimulator::Config robotDrivetrain() {
+	DrivetrainSimulator::Config config;
+	for (const MotorPort& port : LEFT_DRIVE_PORTS) {
+		config.left.push_back({port.port, port.reversed});
+	}
+	for (const MotorPort& port : RIGHT_DRIVE_PORTS) {
+		config.right.push_back({port.port, port.reversed});
+	}
+	config.cartridge = DRIVE_MAX_RPM == 600 ? 2 : DRIVE_MAX_RPM == 200 ? 1 : 0;
+	config.gearRatio = DRIVE_GEAR_RATIO;
+	config.wheelDiameter = DRIVE_WHEEL_DIAMETER;
+	config.trackWidth = DRIVE_TRACK_WIDTH;
+	// not in RobotSpecifics.h yet, rough guesses until measured
+	config.wheelbase = 10;
+	config.mass = 6.8;
+	return config;
+}
+
+} // namespace sim
@@ -0,0 +1,237 @@
+// Runs the robot program on the host: bin/host/robot [auton|driver|replay LOG] [options]
+//
+//   --time SECONDS   how long to run the mode (default 15 auton, 10 driver,
+//                    the length of the log for replay)
+//   --forward N      hold the forward stick at N in driver mode
+//   --turn N         hold the turn stick at N in driver mode
+//   --usd            insert an SD card, so driver control records a match
+//                    log under USD_ROOT
+//   --trace          in replay, print each frame's inputs and the motor
+//                    commands in effect as CSV
+//   --lcd            echo LLEMU lines as they change
+//   --realtime       run at wall clock speed instead of as fast as possible
+//
+// initialize() runs first with the robot disabled, as on the field, then the
+// chosen mode runs in its own task until it returns or time runs out, then
+// the task is removed and disabled() runs. The drivetrain is simulated from
+// RobotSpecifics.h. Ends with a summary of where the robot, motors and IMU
+// ended up and the latency tables.
+//
+// replay runs driver control on a match log recorded by MatchRecorder: the
+// controller input and sensor readings come from the log frame by frame, in
+// step with the recording, instead of from the simulated drivetrain. It
+// stops when the log runs out.
+#include "main.h"
+#include "Latency.h"
+#include "MatchRecorder.h"
+#include "sim/DrivetrainSimulator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LEFT_Y_CHANNEL 1
+#define RIGHT_X_CHANNEL 2
+
+static void usage(const char* name) {
+	fprintf(stderr,
+	        "usage: %s [auton|driver|replay LOG] [--time SECONDS] [--forward N] [--turn N] [--usd] [--trace] [--lcd]"
+	        " [--realtime]\n",
+	        name);
+	exit(2);
+}
+
+// Replayed sensors stay where the log puts them
+class ReplayPlant : public sim::Plant {
+public:
+	void step(sim::World& world, double dt) override {}
+};
+
+static bool trace = false;
+
+static void replay_frame(const MatchFrame& frame, const MatchReader& reader) {
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	if (trace) {
+		// the commands the previous loop left the motors with
+		printf("%u,%d,%d,%d,%d,%03x", frame.time, frame.analog[0], frame.analog[1], frame.analog[2], frame.analog[3],
+		       frame.digital);
+		for (int i = 0; i < reader.getMotorCount(); i++) {
+			const sim::MotorState& motor = sim::world().motors[reader.getPorts()[i]];
+			printf(",%ld", std::lround((motor.reversed ? -1 : 1) * sim::commandedVoltage(sim::world(), motor)));
+		}
+		printf("\n");
+	}
+	for (int channel = 0; channel < sim::NUM_ANALOG; channel++) {
+		sim::setAnalog(pros::E_CONTROLLER_MASTER, channel, frame.analog[channel]);
+	}
+	for (int i = 0; i < sim::NUM_DIGITAL; i++) {
+		sim::setDigital(pros::E_CONTROLLER_MASTER, sim::FIRST_DIGITAL + i, frame.digital >> i & 1);
+	}
+	for (int i = 0; i < reader.getMotorCount(); i++) {
+		sim::setMotorReading(reader.getPorts()[i], frame.position[i], frame.velocity[i] / 100.0, frame.current[i],
+		                     frame.voltage[i]);
+	}
+	sim::setImuReading(reader.getImuPort(), frame.rotation / 1000.0, frame.rate / 100.0);
+}
+
+// the recorder driver control captures through, in main.cpp
+extern MatchRecorder match_recorder;
+
+static bool imus_calibrating() {
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	for (const sim::ImuState& imu : sim::world().imus) {
+		if (imu.connected && pros::millis() < imu.calibratedAt) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// drivetrain is null when replaying
+static void print_summary(const sim::DrivetrainSimulator* drivetrain) {
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	sim::World& world = sim::world();
+	printf("\nafter %.3f s simulated\n", world.time);
+	if (drivetrain) {
+		sim::DrivetrainSimulator::Pose pose = drivetrain->getPose();
+		printf("pose x %.2f in, y %.2f in, heading %.2f deg, battery %.2f V\n", pose.x, pose.y, pose.heading,
+		       world.batteryVoltage / 1000.0);
+	}
+	printf("%-6s %12s %10s %10s\n", "motor", "position", "rpm", "mV");
+	for (int port = 1; port <= sim::NUM_PORTS; port++) {
+		const sim::MotorState& motor = world.motors[port];
+		if (motor.connected) {
+			printf("%-6d %12.1f %10.1f %10.0f\n", port, motor.position, motor.velocity, motor.appliedVoltage);
+		}
+	}
+	for (int port = 1; port <= sim::NUM_PORTS; port++) {
+		const sim::ImuState& imu = world.imus[port];
+		if (imu.connected) {
+			printf("imu %d rotation %.2f deg\n", port, imu.rotation);
+		}
+	}
+	for (int port = 1; port <= sim::NUM_ADI; port++) {
+		if (world.adi[port]) {
+			printf("adi %c = %d\n", 'A' + port - 1, (int) world.adi[port]);
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	bool driver = false;
+	bool realTime = false;
+	double seconds = -1;
+	int forward = 0;
+	int turn = 0;
+	const char* replay = nullptr;
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (strcmp(arg, "auton") == 0) {
+			driver = false;
+		} else if (strcmp(arg, "driver") == 0) {
+			driver = true;
+		} else if (strcmp(arg, "replay") == 0 && hasValue) {
+			driver = true;
+			replay = argv[++i];
+		} else if (strcmp(arg, "--time") == 0 && hasValue) {
+			seconds = atof(argv[++i]);
+		} else if (strcmp(arg, "--forward") == 0 && hasValue) {
+			forward = atoi(argv[++i]);
+		} else if (strcmp(arg, "--turn") == 0 && hasValue) {
+			turn = atoi(argv[++i]);
+		} else if (strcmp(arg, "--usd") == 0) {
+			sim::world().usdInstalled = true;
+		} else if (strcmp(arg, "--trace") == 0) {
+			trace = true;
+		} else if (strcmp(arg, "--realtime") == 0) {
+			realTime = true;
+		} else if (strcmp(arg, "--lcd") == 0) {
+			sim::world().printLcd = true;
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (sim::world().usdInstalled) {
+		mkdir(USD_ROOT, 0755);
+	}
+
+	std::shared_ptr<sim::DrivetrainSimulator> drivetrain;
+	if (replay) {
+		MatchReader reader;
+		MatchFrame frame;
+		if (!reader.open(replay)) {
+			fprintf(stderr, "%s: not a match log\n", replay);
+			exit(1);
+		}
+		uint32_t frames = 0;
+		while (reader.next(frame)) {
+			frames++;
+		}
+		printf("replaying %u frames, %.3f s\n", frames, frame.time / 1000.0);
+		if (seconds < 0) {
+			seconds = frame.time / 1000.0 + 0.1;
+		}
+		if (trace) {
+			printf("time,left_x,left_y,right_x,right_y,buttons");
+			for (int i = 0; i < reader.getMotorCount(); i++) {
+				printf(",mv%d", reader.getPorts()[i]);
+			}
+			printf("\n");
+		}
+		MatchRecorder::replayFrom(replay, replay_frame);
+		sim::setPlant(std::make_shared<ReplayPlant>());
+	} else {
+		drivetrain = std::make_shared<sim::DrivetrainSimulator>(sim::robotDrivetrain());
+		drivetrain->install(sim::world());
+		sim::setPlant(drivetrain);
+	}
+	if (seconds < 0) {
+		seconds = driver ? 10 : 15;
+	}
+
+	sim::world().competitionStatus = COMPETITION_DISABLED;
+	sim::start(realTime);
+	initialize();
+	competition_initialize();
+
+	// the brain runs competition_initialize() until the field enables the
+	// robot; give the IMU time to finish calibrating first
+	while (imus_calibrating()) {
+		pros::delay(10);
+	}
+
+	sim::world().competitionStatus = driver ? 0 : COMPETITION_AUTONOMOUS;
+	if (driver && !replay) {
+		sim::setAnalog(pros::E_CONTROLLER_MASTER, LEFT_Y_CHANNEL, forward);
+		sim::setAnalog(pros::E_CONTROLLER_MASTER, RIGHT_X_CHANNEL, turn);
+	}
+	uint32_t start = pros::millis();
+	pros::Task mode([driver] { driver ? opcontrol() : autonomous(); }, "mode");
+	while (pros::millis() - start < seconds * 1000 && mode.get_state() != pros::E_TASK_STATE_DELETED &&
+	       !(replay && match_recorder.isReplayDone())) {
+		pros::delay(10);
+	}
+	printf("%s %s after %.3f s\n", driver ? "driver" : "autonomous",
+	       mode.get_state() == pros::E_TASK_STATE_DELETED ? "finished" : "stopped", (pros::millis() - start) / 1000.0);
+	if (replay) {
+		printf("replayed %u frames%s\n", match_recorder.getFrames(),
+		       match_recorder.isReplayDone() ? ", the log ran out" : ", stopped before the end of the log");
+	}
+
+	// like the field, end the mode's task before running disabled()
+	mode.remove();
+	mode.join();
+	sim::world().competitionStatus = COMPETITION_DISABLED;
+	disabled();
+	pros::delay(50);
+
+	print_summary(drivetrain.get());
+	LatencySection::dumpAll();
+	fflush(stdout);
+	// the robot's tasks never return; skip static destructors they may still use
+	_exit(0);
+}
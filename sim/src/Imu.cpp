@@ -0,0 +1,312 @@
+// pros/imu.h and pros::Imu against the simulated world
+#include "api.h"
+#include "sim/Sim.h"
+
+#include <cerrno>
+#include <cmath>
+
+using sim::ImuState;
+
+namespace {
+
+bool calibrating(const ImuState& imu) {
+	return pros::c::millis() < imu.calibratedAt;
+}
+
+// Like with_motor: run fn on the IMU at port with the world locked. Readings
+// fail with EAGAIN while the IMU is calibrating, as on the brain.
+template <typename T, typename F> T with_imu(uint8_t port, T error, F fn, bool reading = true) {
+	if (port < 1 || port > sim::NUM_PORTS) {
+		errno = ENXIO;
+		return error;
+	}
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	ImuState& imu = sim::world().imus[port];
+	imu.connected = true;
+	if (reading && calibrating(imu)) {
+		errno = EAGAIN;
+		return error;
+	}
+	return fn(imu);
+}
+
+double rotation(const ImuState& imu) {
+	return imu.reportedRotation - imu.rotationOffset;
+}
+
+double heading(const ImuState& imu) {
+	double heading = std::fmod(imu.reportedRotation - imu.headingOffset, 360);
+	return heading < 0 ? heading + 360 : heading;
+}
+
+double yaw(const ImuState& imu) {
+	double h = heading(imu);
+	return h > 180 ? h - 360 : h;
+}
+
+} // namespace
+
+namespace pros {
+namespace c {
+
+int32_t imu_reset(uint8_t port) {
+	return with_imu(
+	    port, PROS_ERR,
+	    [](ImuState& imu) {
+		    imu.calibratedAt = millis() + sim::world().imuCalibrationMs;
+		    imu.rotationOffset = imu.rotation;
+		    imu.headingOffset = imu.rotation;
+		    return 1;
+	    },
+	    false);
+}
+
+int32_t imu_reset_blocking(uint8_t port) {
+	if (imu_reset(port) == PROS_ERR) {
+		return PROS_ERR;
+	}
+	while (imu_get_status(port) & E_IMU_STATUS_CALIBRATING) {
+		delay(10);
+	}
+	return 1;
+}
+
+int32_t imu_set_data_rate(uint8_t port, uint32_t rate) {
+	return with_imu(port, PROS_ERR, [](ImuState& imu) { return 1; }, false);
+}
+
+double imu_get_rotation(uint8_t port) {
+	return with_imu(port, PROS_ERR_F, [](ImuState& imu) { return rotation(imu); });
+}
+
+double imu_get_heading(uint8_t port) {
+	return with_imu(port, PROS_ERR_F, [](ImuState& imu) { return heading(imu); });
+}
+
+quaternion_s_t imu_get_quaternion(uint8_t port) {
+	quaternion_s_t error = {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	return with_imu(port, error, [](ImuState& imu) {
+		// yaw only; pitch and roll are small enough on a drivetrain to ignore
+		double half = -yaw(imu) * M_PI / 360;
+		return quaternion_s_t{0, 0, std::sin(half), std::cos(half)};
+	});
+}
+
+euler_s_t imu_get_euler(uint8_t port) {
+	euler_s_t error = {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	return with_imu(port, error, [](ImuState& imu) { return euler_s_t{imu.pitch, imu.roll, yaw(imu)}; });
+}
+
+double imu_get_pitch(uint8_t port) {
+	return with_imu(port, PROS_ERR_F, [](ImuState& imu) { return imu.pitch; });
+}
+
+double imu_get_roll(uint8_t port) {
+	return with_imu(port, PROS_ERR_F, [](ImuState& imu) { return imu.roll; });
+}
+
+double imu_get_yaw(uint8_t port) {
+	return with_imu(port, PROS_ERR_F, [](ImuState& imu) { return yaw(imu); });
+}
+
+imu_gyro_s_t imu_get_gyro_rate(uint8_t port) {
+	imu_gyro_s_t error = {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	// the sensor's z axis points up, so clockwise rotation reads negative
+	return with_imu(port, error, [](ImuState& imu) { return imu_gyro_s_t{0, 0, -imu.reportedRate}; });
+}
+
+imu_accel_s_t imu_get_accel(uint8_t port) {
+	imu_accel_s_t error = {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	return with_imu(port, error,
+	                [](ImuState& imu) { return imu_accel_s_t{imu.accel[0], imu.accel[1], imu.accel[2]}; });
+}
+
+imu_status_e_t imu_get_status(uint8_t port) {
+	return with_imu(
+	    port, E_IMU_STATUS_ERROR,
+	    [](ImuState& imu) { return calibrating(imu) ? E_IMU_STATUS_CALIBRATING : (imu_status_e_t) 0; }, false);
+}
+
+int32_t imu_tare_heading(uint8_t port) {
+	return imu_set_heading(port, 0);
+}
+
+int32_t imu_tare_rotation(uint8_t port) {
+	return imu_set_rotation(port, 0);
+}
+
+// pitch and roll are whatever the plant says they are
+int32_t imu_tare_pitch(uint8_t port) {
+	return with_imu(port, PROS_ERR, [](ImuState& imu) { return 1; });
+}
+
+int32_t imu_tare_roll(uint8_t port) {
+	return with_imu(port, PROS_ERR, [](ImuState& imu) { return 1; });
+}
+
+int32_t imu_tare_yaw(uint8_t port) {
+	return imu_set_yaw(port, 0);
+}
+
+int32_t imu_tare_euler(uint8_t port) {
+	return imu_tare_yaw(port);
+}
+
+int32_t imu_tare(uint8_t port) {
+	if (imu_tare_rotation(port) == PROS_ERR) {
+		return PROS_ERR;
+	}
+	return imu_tare_heading(port);
+}
+
+int32_t imu_set_euler(uint8_t port, euler_s_t target) {
+	return imu_set_yaw(port, target.yaw);
+}
+
+int32_t imu_set_rotation(uint8_t port, double target) {
+	return with_imu(port, PROS_ERR, [&](ImuState& imu) {
+		imu.rotationOffset = imu.reportedRotation - target;
+		return 1;
+	});
+}
+
+int32_t imu_set_heading(uint8_t port, double target) {
+	return with_imu(port, PROS_ERR, [&](ImuState& imu) {
+		imu.headingOffset = imu.reportedRotation - target;
+		return 1;
+	});
+}
+
+int32_t imu_set_pitch(uint8_t port, double target) {
+	return imu_tare_pitch(port);
+}
+
+int32_t imu_set_roll(uint8_t port, double target) {
+	return imu_tare_roll(port);
+}
+
+int32_t imu_set_yaw(uint8_t port, double target) {
+	return imu_set_heading(port, target < 0 ? target + 360 : target);
+}
+
+} // namespace c
+
+std::int32_t Imu::reset(bool blocking) const {
+	return blocking ? c::imu_reset_blocking(_port) : c::imu_reset(_port);
+}
+
+std::int32_t Imu::set_data_rate(std::uint32_t rate) const {
+	return c::imu_set_data_rate(_port, rate);
+}
+
+double Imu::get_rotation() const {
+	return c::imu_get_rotation(_port);
+}
+
+double Imu::get_heading() const {
+	return c::imu_get_heading(_port);
+}
+
+c::quaternion_s_t Imu::get_quaternion() const {
+	return c::imu_get_quaternion(_port);
+}
+
+c::euler_s_t Imu::get_euler() const {
+	return c::imu_get_euler(_port);
+}
+
+double Imu::get_pitch() const {
+	return c::imu_get_pitch(_port);
+}
+
+double Imu::get_roll() const {
+	return c::imu_get_roll(_port);
+}
+
+double Imu::get_yaw() const {
+	return c::imu_get_yaw(_port);
+}
+
+c::imu_gyro_s_t Imu::get_gyro_rate() const {
+	return c::imu_get_gyro_rate(_port);
+}
+
+std::int32_t Imu::tare_rotation() const {
+	return c::imu_tare_rotation(_port);
+}
+
+std::int32_t Imu::tare_heading() const {
+	return c::imu_tare_heading(_port);
+}
+
+std::int32_t Imu::tare_pitch() const {
+	return c::imu_tare_pitch(_port);
+}
+
+std::int32_t Imu::tare_yaw() const {
+	return c::imu_tare_yaw(_port);
+}
+
+std::int32_t Imu::tare_roll() const {
+	return c::imu_tare_roll(_port);
+}
+
+std::int32_t Imu::tare() const {
+	return c::imu_tare(_port);
+}
+
+std::int32_t Imu::tare_euler() const {
+	return c::imu_tare_euler(_port);
+}
+
+std::int32_t Imu::set_heading(const double target) const {
+	return c::imu_set_heading(_port, target);
+}
+
+std::int32_t Imu::set_rotation(const double target) const {
+	return c::imu_set_rotation(_port, target);
+}
+
+std::int32_t Imu::set_yaw(const double target) const {
+	return c::imu_set_yaw(_port, target);
+}
+
+std::int32_t Imu::set_pitch(const double target) const {
+	return c::imu_set_pitch(_port, target);
+}
+
+std::int32_t Imu::set_roll(const double target) const {
+	return c::imu_set_roll(_port, target);
+}
+
+std::int32_t Imu::set_euler(const c::euler_s_t target) const {
+	return c::imu_set_euler(_port, target);
+}
+
+c::imu_accel_s_t Imu::get_accel() const {
+	return c::imu_get_accel(_port);
+}
+
+c::imu_status_e_t Imu::get_status() const {
+	return c::imu_get_status(_port);
+}
+
+bool Imu::is_calibrating() const {
+	return get_status() & c::E_IMU_STATUS_CALIBRATING;
+}
+
+} // namespace pros
+
+namespace sim {
+
+void setImuReading(int port, double rotation, double gyroZ) {
+	with_imu((uint8_t) port, 0, [&](ImuState& imu) {
+		imu.rotation = rotation + imu.rotationOffset;
+		imu.rate = -gyroZ;
+		imu.reportedRotation = imu.rotation;
+		imu.reportedRate = imu.rate;
+		return 0;
+	}, false);
+}
+
+} // namespace sim
@@ -0,0 +1,175 @@
+// pros/llemu.h and pros/llemu.hpp. Lines are kept in World::lcd and echoed to
+// stdout when World::printLcd is set.
+#include "api.h"
+#include "sim/Sim.h"
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+bool initialized = false;
+pros::lcd_btn_cb_fn_t callbacks[3] = {};
+uint8_t buttons = 0;
+
+bool write_line(int16_t line, const char* text) {
+	if (!initialized) {
+		errno = ENXIO;
+		return false;
+	}
+	if (line < 0 || line >= sim::LCD_LINES) {
+		errno = EINVAL;
+		return false;
+	}
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	sim::World& world = sim::world();
+	char* dest = world.lcd[line];
+	if (strncmp(dest, text, sim::LCD_LINE_LENGTH - 1) == 0) {
+		return true;
+	}
+	snprintf(dest, sim::LCD_LINE_LENGTH, "%s", text);
+	if (world.printLcd) {
+		printf("[%8.3f] lcd %d: %s\n", pros::c::millis() / 1000.0, line, dest);
+	}
+	return true;
+}
+
+} // namespace
+
+namespace sim {
+
+void pressLcdButton(int button) {
+	if (button < 0 || button > 2) {
+		return;
+	}
+	buttons |= 4 >> button; // LCD_BTN_LEFT is the high bit
+	if (callbacks[button]) {
+		callbacks[button]();
+	}
+	buttons &= ~(4 >> button);
+}
+
+} // namespace sim
+
+namespace pros {
+namespace c {
+
+bool lcd_is_initialized(void) {
+	return initialized;
+}
+
+bool lcd_initialize(void) {
+	initialized = true;
+	return true;
+}
+
+bool lcd_shutdown(void) {
+	initialized = false;
+	return true;
+}
+
+bool lcd_print(int16_t line, const char* fmt, ...) {
+	char text[sim::LCD_LINE_LENGTH];
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf(text, sizeof(text), fmt, args);
+	va_end(args);
+	return write_line(line, text);
+}
+
+bool lcd_set_text(int16_t line, const char* text) {
+	return write_line(line, text);
+}
+
+bool lcd_clear(void) {
+	for (int16_t line = 0; line < sim::LCD_LINES; line++) {
+		if (!write_line(line, "")) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool lcd_clear_line(int16_t line) {
+	return write_line(line, "");
+}
+
+bool lcd_register_btn0_cb(lcd_btn_cb_fn_t cb) {
+	callbacks[0] = cb;
+	return initialized;
+}
+
+bool lcd_register_btn1_cb(lcd_btn_cb_fn_t cb) {
+	callbacks[1] = cb;
+	return initialized;
+}
+
+bool lcd_register_btn2_cb(lcd_btn_cb_fn_t cb) {
+	callbacks[2] = cb;
+	return initialized;
+}
+
+uint8_t lcd_read_buttons(void) {
+	return buttons;
+}
+
+void lcd_set_background_color(lv_color_t color) {}
+
+void lcd_set_text_color(lv_color_t color) {}
+
+} // namespace c
+
+namespace lcd {
+
+bool is_initialized(void) {
+	return c::lcd_is_initialized();
+}
+
+bool initialize(void) {
+	return c::lcd_initialize();
+}
+
+bool shutdown(void) {
+	return c::lcd_shutdown();
+}
+
+bool set_text(std::int16_t line, std::string text) {
+	return c::lcd_set_text(line, text.c_str());
+}
+
+bool clear(void) {
+	return c::lcd_clear();
+}
+
+bool clear_line(std::int16_t line) {
+	return c::lcd_clear_line(line);
+}
+
+void register_btn0_cb(lcd_btn_cb_fn_t cb) {
+	c::lcd_register_btn0_cb(cb);
+}
+
+void register_btn1_cb(lcd_btn_cb_fn_t cb) {
+	c::lcd_register_btn1_cb(cb);
+}
+
+void register_btn2_cb(lcd_btn_cb_fn_t cb) {
+	c::lcd_register_btn2_cb(cb);
+}
+
+std::uint8_t read_buttons(void) {
+	return c::lcd_read_buttons();
+}
+
+void set_background_color(lv_color_t color) {}
+
+void set_background_color(std::uint8_t r, std::uint8_t g, std::uint8_t b) {}
+
+void set_text_color(lv_color_t color) {}
+
+void set_text_color(std::uint8_t r, std::uint8_t g, std::uint8_t b) {}
+
+} // namespace lcd
+} // namespace pros
@@ -0,0 +1,219 @@
+// pros/misc.h and pros/misc.hpp: controllers, battery, competition and SD card
+#include "api.h"
+#include "sim/Sim.h"
+
+#include <cerrno>
+#include <cstdarg>
+
+namespace {
+
+template <typename F> int32_t with_controller(pros::controller_id_e_t id, F fn) {
+	if (id != pros::E_CONTROLLER_MASTER && id != pros::E_CONTROLLER_PARTNER) {
+		errno = EINVAL;
+		return PROS_ERR;
+	}
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	return fn(sim::world().controllers[id]);
+}
+
+bool valid_button(pros::controller_digital_e_t button) {
+	return button >= sim::FIRST_DIGITAL && button < sim::FIRST_DIGITAL + sim::NUM_DIGITAL;
+}
+
+} // namespace
+
+namespace pros {
+namespace c {
+
+uint8_t competition_get_status(void) {
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	return sim::world().competitionStatus;
+}
+
+int32_t controller_is_connected(controller_id_e_t id) {
+	return with_controller(id, [](sim::ControllerState& state) { return (int32_t) state.connected; });
+}
+
+int32_t controller_get_analog(controller_id_e_t id, controller_analog_e_t channel) {
+	if (channel < 0 || channel >= sim::NUM_ANALOG) {
+		errno = EINVAL;
+		return 0;
+	}
+	return with_controller(id, [&](sim::ControllerState& state) { return state.analog[channel]; });
+}
+
+int32_t controller_get_battery_capacity(controller_id_e_t id) {
+	return with_controller(id, [](sim::ControllerState& state) { return 100; });
+}
+
+int32_t controller_get_battery_level(controller_id_e_t id) {
+	return with_controller(id, [](sim::ControllerState& state) { return 100; });
+}
+
+int32_t controller_get_digital(controller_id_e_t id, controller_digital_e_t button) {
+	if (!valid_button(button)) {
+		errno = EINVAL;
+		return 0;
+	}
+	return with_controller(id, [&](sim::ControllerState& state) {
+		return (int32_t) state.digital[button - sim::FIRST_DIGITAL];
+	});
+}
+
+int32_t controller_get_digital_new_press(controller_id_e_t id, controller_digital_e_t button) {
+	if (!valid_button(button)) {
+		errno = EINVAL;
+		return 0;
+	}
+	return with_controller(id, [&](sim::ControllerState& state) {
+		bool& pressed = state.newPress[button - sim::FIRST_DIGITAL];
+		bool result = pressed;
+		pressed = false;
+		return (int32_t) result;
+	});
+}
+
+// the controller screen is not shown anywhere
+int32_t controller_print(controller_id_e_t id, uint8_t line, uint8_t col, const char* fmt, ...) {
+	return with_controller(id, [](sim::ControllerState& state) { return 1; });
+}
+
+int32_t controller_set_text(controller_id_e_t id, uint8_t line, uint8_t col, const char* str) {
+	return with_controller(id, [](sim::ControllerState& state) { return 1; });
+}
+
+int32_t controller_clear_line(controller_id_e_t id, uint8_t line) {
+	return with_controller(id, [](sim::ControllerState& state) { return 1; });
+}
+
+int32_t controller_clear(controller_id_e_t id) {
+	return with_controller(id, [](sim::ControllerState& state) { return 1; });
+}
+
+int32_t controller_rumble(controller_id_e_t id, const char* rumble_pattern) {
+	return with_controller(id, [](sim::ControllerState& state) { return 1; });
+}
+
+int32_t battery_get_voltage(void) {
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	return sim::world().batteryVoltage;
+}
+
+int32_t battery_get_current(void) {
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	double current = 0;
+	for (const sim::MotorState& motor : sim::world().motors) {
+		current += motor.reportedCurrent;
+	}
+	return (int32_t) current;
+}
+
+double battery_get_temperature(void) {
+	return 25;
+}
+
+double battery_get_capacity(void) {
+	return 100;
+}
+
+int32_t usd_is_installed(void) {
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	return sim::world().usdInstalled;
+}
+
+} // namespace c
+
+Controller::Controller(controller_id_e_t id) : _id(id) {}
+
+std::int32_t Controller::is_connected(void) {
+	return c::controller_is_connected(_id);
+}
+
+std::int32_t Controller::get_analog(controller_analog_e_t channel) {
+	return c::controller_get_analog(_id, channel);
+}
+
+std::int32_t Controller::get_battery_capacity(void) {
+	return c::controller_get_battery_capacity(_id);
+}
+
+std::int32_t Controller::get_battery_level(void) {
+	return c::controller_get_battery_level(_id);
+}
+
+std::int32_t Controller::get_digital(controller_digital_e_t button) {
+	return c::controller_get_digital(_id, button);
+}
+
+std::int32_t Controller::get_digital_new_press(controller_digital_e_t button) {
+	return c::controller_get_digital_new_press(_id, button);
+}
+
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const char* str) {
+	return c::controller_set_text(_id, line, col, str);
+}
+
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const std::string& str) {
+	return c::controller_set_text(_id, line, col, str.c_str());
+}
+
+std::int32_t Controller::clear_line(std::uint8_t line) {
+	return c::controller_clear_line(_id, line);
+}
+
+std::int32_t Controller::rumble(const char* rumble_pattern) {
+	return c::controller_rumble(_id, rumble_pattern);
+}
+
+std::int32_t Controller::clear(void) {
+	return c::controller_clear(_id);
+}
+
+namespace battery {
+
+double get_capacity(void) {
+	return c::battery_get_capacity();
+}
+
+int32_t get_current(void) {
+	return c::battery_get_current();
+}
+
+double get_temperature(void) {
+	return c::battery_get_temperature();
+}
+
+int32_t get_voltage(void) {
+	return c::battery_get_voltage();
+}
+
+} // namespace battery
+
+namespace competition {
+
+std::uint8_t get_status(void) {
+	return c::competition_get_status();
+}
+
+std::uint8_t is_autonomous(void) {
+	return (c::competition_get_status() & COMPETITION_AUTONOMOUS) != 0;
+}
+
+std::uint8_t is_connected(void) {
+	return (c::competition_get_status() & COMPETITION_CONNECTED) != 0;
+}
+
+std::uint8_t is_disabled(void) {
+	return (c::competition_get_status() & COMPETITION_DISABLED) != 0;
+}
+
+} // namespace competition
+
+namespace usd {
+
+std::int32_t is_installed(void) {
+	return c::usd_is_installed();
+}
+
+} // namespace usd
+} // namespace pros
@@ -0,0 +1,593 @@
+// pros/motors.h and pros::Motor against the simulated world
+#include "api.h"
+#include "sim/Sim.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+
+using sim::MotorState;
+
+namespace {
+
+// Run fn on the motor at port with the world locked, or set errno and
+// return error for a bad port. Any valid port counts as a plugged in motor.
+template <typename T, typename F> T with_motor(uint8_t port, T error, F fn) {
+	if (port < 1 || port > sim::NUM_PORTS) {
+		errno = ENXIO;
+		return error;
+	}
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	MotorState& motor = sim::world().motors[port];
+	motor.connected = true;
+	return fn(motor);
+}
+
+double direction(const MotorState& motor) {
+	return motor.reversed ? -1 : 1;
+}
+
+// Reported over physical output shaft motion. The motor counts raw encoder
+// ticks and scales them by the configured gearset, so a mismatched cartridge
+// reads fast or slow.
+double cartridge_scale(const MotorState& motor) {
+	return sim::countsPerRev(sim::cartridgeOf(motor)) / sim::countsPerRev(motor.gearset);
+}
+
+// reported degrees per encoder unit
+double unit_scale(const MotorState& motor) {
+	switch (motor.encoderUnits) {
+	case pros::E_MOTOR_ENCODER_ROTATIONS:
+		return 360;
+	case pros::E_MOTOR_ENCODER_COUNTS:
+		return 360 / sim::countsPerRev(motor.gearset);
+	default:
+		return 1;
+	}
+}
+
+double to_units(const MotorState& motor, double physicalDegrees) {
+	return (direction(motor) * physicalDegrees * cartridge_scale(motor) - motor.zeroPosition) / unit_scale(motor);
+}
+
+double to_physical(const MotorState& motor, double units) {
+	return direction(motor) * (units * unit_scale(motor) + motor.zeroPosition) / cartridge_scale(motor);
+}
+
+// a velocity command in the configured gearset's rpm to physical rpm
+double to_physical_rpm(const MotorState& motor, int32_t velocity) {
+	int32_t max = (int32_t) sim::maxRpm(motor.gearset);
+	return std::clamp(velocity, -max, max) / cartridge_scale(motor);
+}
+
+} // namespace
+
+namespace pros {
+namespace c {
+
+int32_t motor_move(uint8_t port, int32_t voltage) {
+	return motor_move_voltage(port, voltage * 12000 / 127);
+}
+
+int32_t motor_brake(uint8_t port) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) {
+		motor.mode = MotorState::Mode::BRAKE;
+		motor.targetVoltage = 0;
+		motor.targetVelocity = 0;
+		return 1;
+	});
+}
+
+int32_t motor_move_absolute(uint8_t port, const double position, const int32_t velocity) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.mode = MotorState::Mode::POSITION;
+		motor.targetPosition = to_physical(motor, position);
+		motor.targetVelocity = std::abs(to_physical_rpm(motor, velocity));
+		return 1;
+	});
+}
+
+int32_t motor_move_relative(uint8_t port, const double position, const int32_t velocity) {
+	double target = motor_get_target_position(port);
+	return motor_move_absolute(port, target + position, velocity);
+}
+
+int32_t motor_move_velocity(uint8_t port, const int32_t velocity) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.mode = MotorState::Mode::VELOCITY;
+		motor.targetVelocity = direction(motor) * to_physical_rpm(motor, velocity);
+		return 1;
+	});
+}
+
+int32_t motor_move_voltage(uint8_t port, const int32_t voltage) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.mode = MotorState::Mode::VOLTAGE;
+		motor.targetVoltage = (int32_t) direction(motor) * std::clamp(voltage, -12000, 12000);
+		return 1;
+	});
+}
+
+int32_t motor_modify_profiled_velocity(uint8_t port, const int32_t velocity) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		if (motor.mode == MotorState::Mode::POSITION) {
+			motor.targetVelocity = std::abs(to_physical_rpm(motor, velocity));
+		}
+		return 1;
+	});
+}
+
+double motor_get_target_position(uint8_t port) {
+	return with_motor(port, PROS_ERR_F,
+	                  [](MotorState& motor) { return to_units(motor, motor.targetPosition); });
+}
+
+int32_t motor_get_target_velocity(uint8_t port) {
+	return with_motor(port, PROS_ERR,
+	                  [](MotorState& motor) {
+		return (int32_t) std::lround(direction(motor) * motor.targetVelocity * cartridge_scale(motor));
+	});
+}
+
+double motor_get_actual_velocity(uint8_t port) {
+	return with_motor(port, PROS_ERR_F,
+	                  [](MotorState& motor) {
+		return direction(motor) * motor.reportedVelocity * cartridge_scale(motor);
+	});
+}
+
+int32_t motor_get_current_draw(uint8_t port) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return (int32_t) motor.reportedCurrent; });
+}
+
+int32_t motor_get_direction(uint8_t port) {
+	return with_motor(port, PROS_ERR,
+	                  [](MotorState& motor) { return direction(motor) * motor.reportedVelocity < 0 ? -1 : 1; });
+}
+
+double motor_get_efficiency(uint8_t port) {
+	return with_motor(port, PROS_ERR_F, [](MotorState& motor) {
+		if (motor.reportedVoltage == 0) {
+			return 0.0;
+		}
+		double free = sim::maxRpm(sim::cartridgeOf(motor)) * std::abs(motor.reportedVoltage) / 12000;
+		return std::min(100.0, 100 * std::abs(motor.reportedVelocity) / free);
+	});
+}
+
+int32_t motor_is_over_current(uint8_t port) {
+	return with_motor(port, PROS_ERR,
+	                  [](MotorState& motor) { return (int32_t) (motor.reportedCurrent >= motor.currentLimit); });
+}
+
+int32_t motor_is_over_temp(uint8_t port) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return (int32_t) (motor.temperature >= 55); });
+}
+
+int32_t motor_is_stopped(uint8_t port) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return (int32_t) (motor.reportedVelocity == 0); });
+}
+
+int32_t motor_get_zero_position_flag(uint8_t port) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) {
+		return (int32_t) (std::abs(to_units(motor, motor.reportedPosition)) < 1e-9);
+	});
+}
+
+uint32_t motor_get_faults(uint8_t port) {
+	return with_motor(port, (uint32_t) PROS_ERR, [](MotorState& motor) {
+		return motor.reportedCurrent >= motor.currentLimit ? (uint32_t) E_MOTOR_FAULT_OVER_CURRENT : 0u;
+	});
+}
+
+uint32_t motor_get_flags(uint8_t port) {
+	return with_motor(port, (uint32_t) PROS_ERR, [](MotorState& motor) { return 0u; });
+}
+
+int32_t motor_get_raw_position(uint8_t port, uint32_t* const timestamp) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		if (timestamp) {
+			*timestamp = motor.reportedTimestamp;
+		}
+		// raw counts ignore the encoder unit setting and tare, but not reversal
+		double counts = sim::countsPerRev(sim::cartridgeOf(motor)) / 360;
+		return (int32_t) std::lround(direction(motor) * motor.reportedPosition * counts);
+	});
+}
+
+double motor_get_position(uint8_t port) {
+	return with_motor(port, PROS_ERR_F, [](MotorState& motor) { return to_units(motor, motor.reportedPosition); });
+}
+
+double motor_get_power(uint8_t port) {
+	return with_motor(port, PROS_ERR_F, [](MotorState& motor) {
+		return std::abs(motor.reportedVoltage * motor.reportedCurrent) / 1e6;
+	});
+}
+
+double motor_get_temperature(uint8_t port) {
+	return with_motor(port, PROS_ERR_F, [](MotorState& motor) { return motor.temperature; });
+}
+
+double motor_get_torque(uint8_t port) {
+	return with_motor(port, PROS_ERR_F, [](MotorState& motor) { return motor.reportedTorque; });
+}
+
+int32_t motor_get_voltage(uint8_t port) {
+	return with_motor(port, PROS_ERR,
+	                  [](MotorState& motor) { return (int32_t) (direction(motor) * motor.reportedVoltage); });
+}
+
+int32_t motor_set_zero_position(uint8_t port, const double position) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.zeroPosition += position * unit_scale(motor);
+		return 1;
+	});
+}
+
+int32_t motor_tare_position(uint8_t port) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) {
+		motor.zeroPosition = direction(motor) * motor.reportedPosition * cartridge_scale(motor);
+		return 1;
+	});
+}
+
+int32_t motor_set_brake_mode(uint8_t port, const motor_brake_mode_e_t mode) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.brakeMode = mode;
+		return 1;
+	});
+}
+
+int32_t motor_set_current_limit(uint8_t port, const int32_t limit) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.currentLimit = std::clamp(limit, 0, 2500);
+		return 1;
+	});
+}
+
+int32_t motor_set_encoder_units(uint8_t port, const motor_encoder_units_e_t units) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.encoderUnits = units;
+		return 1;
+	});
+}
+
+int32_t motor_set_gearing(uint8_t port, const motor_gearset_e_t gearset) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.gearset = gearset;
+		return 1;
+	});
+}
+
+// the internal PID constants are not modelled
+motor_pid_s_t motor_convert_pid(double kf, double kp, double ki, double kd) {
+	motor_pid_s_t pid = {};
+	pid.kf = (uint8_t) (kf * 16);
+	pid.kp = (uint8_t) (kp * 16);
+	pid.ki = (uint8_t) (ki * 16);
+	pid.kd = (uint8_t) (kd * 16);
+	return pid;
+}
+
+motor_pid_full_s_t motor_convert_pid_full(double kf, double kp, double ki, double kd, double filter, double limit,
+                                          double threshold, double loopspeed) {
+	motor_pid_full_s_t pid = {};
+	pid.kf = (uint8_t) (kf * 16);
+	pid.kp = (uint8_t) (kp * 16);
+	pid.ki = (uint8_t) (ki * 16);
+	pid.kd = (uint8_t) (kd * 16);
+	pid.filter = (uint8_t) (filter * 16);
+	pid.limit = (uint16_t) (limit * 16);
+	pid.threshold = (uint8_t) (threshold * 16);
+	pid.loopspeed = (uint8_t) (loopspeed * 16);
+	return pid;
+}
+
+int32_t motor_set_pos_pid(uint8_t port, const motor_pid_s_t pid) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return 1; });
+}
+
+int32_t motor_set_pos_pid_full(uint8_t port, const motor_pid_full_s_t pid) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return 1; });
+}
+
+int32_t motor_set_vel_pid(uint8_t port, const motor_pid_s_t pid) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return 1; });
+}
+
+int32_t motor_set_vel_pid_full(uint8_t port, const motor_pid_full_s_t pid) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return 1; });
+}
+
+motor_pid_full_s_t motor_get_pos_pid(uint8_t port) {
+	return motor_pid_full_s_t{};
+}
+
+motor_pid_full_s_t motor_get_vel_pid(uint8_t port) {
+	return motor_pid_full_s_t{};
+}
+
+int32_t motor_set_reversed(uint8_t port, const bool reverse) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.reversed = reverse;
+		return 1;
+	});
+}
+
+int32_t motor_set_voltage_limit(uint8_t port, const int32_t limit) {
+	return with_motor(port, PROS_ERR, [&](MotorState& motor) {
+		motor.voltageLimit = std::clamp(limit, 0, 12000);
+		return 1;
+	});
+}
+
+motor_brake_mode_e_t motor_get_brake_mode(uint8_t port) {
+	return with_motor(port, E_MOTOR_BRAKE_INVALID,
+	                  [](MotorState& motor) { return (motor_brake_mode_e_t) motor.brakeMode; });
+}
+
+int32_t motor_get_current_limit(uint8_t port) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return motor.currentLimit; });
+}
+
+motor_encoder_units_e_t motor_get_encoder_units(uint8_t port) {
+	return with_motor(port, E_MOTOR_ENCODER_INVALID,
+	                  [](MotorState& motor) { return (motor_encoder_units_e_t) motor.encoderUnits; });
+}
+
+motor_gearset_e_t motor_get_gearing(uint8_t port) {
+	return with_motor(port, E_MOTOR_GEARSET_INVALID,
+	                  [](MotorState& motor) { return (motor_gearset_e_t) motor.gearset; });
+}
+
+int32_t motor_is_reversed(uint8_t port) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return (int32_t) motor.reversed; });
+}
+
+int32_t motor_get_voltage_limit(uint8_t port) {
+	return with_motor(port, PROS_ERR, [](MotorState& motor) { return motor.voltageLimit; });
+}
+
+} // namespace c
+
+Motor::Motor(const std::int8_t port, const motor_gearset_e_t gearset, const bool reverse,
+             const motor_encoder_units_e_t encoder_units)
+    : _port(port) {
+	set_gearing(gearset);
+	set_reversed(reverse);
+	set_encoder_units(encoder_units);
+}
+
+Motor::Motor(const std::int8_t port, const motor_gearset_e_t gearset, const bool reverse) : _port(port) {
+	set_gearing(gearset);
+	set_reversed(reverse);
+}
+
+Motor::Motor(const std::int8_t port, const motor_gearset_e_t gearset) : _port(port) {
+	set_gearing(gearset);
+}
+
+Motor::Motor(const std::int8_t port, const bool reverse) : _port(port) {
+	set_reversed(reverse);
+}
+
+Motor::Motor(const std::int8_t port) : _port(port) {}
+
+std::int32_t Motor::operator=(std::int32_t voltage) const {
+	return c::motor_move(_port, voltage);
+}
+
+std::int32_t Motor::move(std::int32_t voltage) const {
+	return c::motor_move(_port, voltage);
+}
+
+std::int32_t Motor::move_absolute(const double position, const std::int32_t velocity) const {
+	return c::motor_move_absolute(_port, position, velocity);
+}
+
+std::int32_t Motor::move_relative(const double position, const std::int32_t velocity) const {
+	return c::motor_move_relative(_port, position, velocity);
+}
+
+std::int32_t Motor::move_velocity(const std::int32_t velocity) const {
+	return c::motor_move_velocity(_port, velocity);
+}
+
+std::int32_t Motor::move_voltage(const std::int32_t voltage) const {
+	return c::motor_move_voltage(_port, voltage);
+}
+
+std::int32_t Motor::brake(void) const {
+	return c::motor_brake(_port);
+}
+
+std::int32_t Motor::modify_profiled_velocity(const std::int32_t velocity) const {
+	return c::motor_modify_profiled_velocity(_port, velocity);
+}
+
+double Motor::get_target_position(void) const {
+	return c::motor_get_target_position(_port);
+}
+
+std::int32_t Motor::get_target_velocity(void) const {
+	return c::motor_get_target_velocity(_port);
+}
+
+double Motor::get_actual_velocity(void) const {
+	return c::motor_get_actual_velocity(_port);
+}
+
+std::int32_t Motor::get_current_draw(void) const {
+	return c::motor_get_current_draw(_port);
+}
+
+std::int32_t Motor::get_direction(void) const {
+	return c::motor_get_direction(_port);
+}
+
+double Motor::get_efficiency(void) const {
+	return c::motor_get_efficiency(_port);
+}
+
+std::int32_t Motor::is_over_current(void) const {
+	return c::motor_is_over_current(_port);
+}
+
+std::int32_t Motor::is_stopped(void) const {
+	return c::motor_is_stopped(_port);
+}
+
+std::int32_t Motor::get_zero_position_flag(void) const {
+	return c::motor_get_zero_position_flag(_port);
+}
+
+std::uint32_t Motor::get_faults(void) const {
+	return c::motor_get_faults(_port);
+}
+
+std::uint32_t Motor::get_flags(void) const {
+	return c::motor_get_flags(_port);
+}
+
+std::int32_t Motor::get_raw_position(std::uint32_t* const timestamp) const {
+	return c::motor_get_raw_position(_port, timestamp);
+}
+
+std::int32_t Motor::is_over_temp(void) const {
+	return c::motor_is_over_temp(_port);
+}
+
+double Motor::get_position(void) const {
+	return c::motor_get_position(_port);
+}
+
+double Motor::get_power(void) const {
+	return c::motor_get_power(_port);
+}
+
+double Motor::get_temperature(void) const {
+	return c::motor_get_temperature(_port);
+}
+
+double Motor::get_torque(void) const {
+	return c::motor_get_torque(_port);
+}
+
+std::int32_t Motor::get_voltage(void) const {
+	return c::motor_get_voltage(_port);
+}
+
+std::int32_t Motor::set_zero_position(const double position) const {
+	return c::motor_set_zero_position(_port, position);
+}
+
+std::int32_t Motor::tare_position(void) const {
+	return c::motor_tare_position(_port);
+}
+
+std::int32_t Motor::set_brake_mode(const motor_brake_mode_e_t mode) const {
+	return c::motor_set_brake_mode(_port, mode);
+}
+
+std::int32_t Motor::set_current_limit(const std::int32_t limit) const {
+	return c::motor_set_current_limit(_port, limit);
+}
+
+std::int32_t Motor::set_encoder_units(const motor_encoder_units_e_t units) const {
+	return c::motor_set_encoder_units(_port, units);
+}
+
+std::int32_t Motor::set_gearing(const motor_gearset_e_t gearset) const {
+	return c::motor_set_gearing(_port, gearset);
+}
+
+motor_pid_s_t Motor::convert_pid(double kf, double kp, double ki, double kd) {
+	return c::motor_convert_pid(kf, kp, ki, kd);
+}
+
+motor_pid_full_s_t Motor::convert_pid_full(double kf, double kp, double ki, double kd, double filter, double limit,
+                                           double threshold, double loopspeed) {
+	return c::motor_convert_pid_full(kf, kp, ki, kd, filter, limit, threshold, loopspeed);
+}
+
+std::int32_t Motor::set_pos_pid(const motor_pid_s_t pid) const {
+	return c::motor_set_pos_pid(_port, pid);
+}
+
+std::int32_t Motor::set_pos_pid_full(const motor_pid_full_s_t pid) const {
+	return c::motor_set_pos_pid_full(_port, pid);
+}
+
+std::int32_t Motor::set_vel_pid(const motor_pid_s_t pid) const {
+	return c::motor_set_vel_pid(_port, pid);
+}
+
+std::int32_t Motor::set_vel_pid_full(const motor_pid_full_s_t pid) const {
+	return c::motor_set_vel_pid_full(_port, pid);
+}
+
+std::int32_t Motor::set_reversed(const bool reverse) const {
+	return c::motor_set_reversed(_port, reverse);
+}
+
+std::int32_t Motor::set_voltage_limit(const std::int32_t limit) const {
+	return c::motor_set_voltage_limit(_port, limit);
+}
+
+motor_brake_mode_e_t Motor::get_brake_mode(void) const {
+	return c::motor_get_brake_mode(_port);
+}
+
+std::int32_t Motor::get_current_limit(void) const {
+	return c::motor_get_current_limit(_port);
+}
+
+motor_encoder_units_e_t Motor::get_encoder_units(void) const {
+	return c::motor_get_encoder_units(_port);
+}
+
+motor_gearset_e_t Motor::get_gearing(void) const {
+	return c::motor_get_gearing(_port);
+}
+
+motor_pid_full_s_t Motor::get_pos_pid(void) const {
+	return c::motor_get_pos_pid(_port);
+}
+
+motor_pid_full_s_t Motor::get_vel_pid(void) const {
+	return c::motor_get_vel_pid(_port);
+}
+
+std::int32_t Motor::is_reversed(void) const {
+	return c::motor_is_reversed(_port);
+}
+
+std::int32_t Motor::get_voltage_limit(void) const {
+	return c::motor_get_voltage_limit(_port);
+}
+
+std::uint8_t Motor::get_port(void) const {
+	return _port;
+}
+
+} // namespace pros
+
+namespace sim {
+
+void setMotorReading(int port, int32_t rawPosition, double velocity, double current, double voltage) {
+	with_motor((uint8_t) port, 0, [&](MotorState& motor) {
+		// the inverse of motor_get_raw_position and friends
+		motor.position = direction(motor) * rawPosition * 360 / countsPerRev(cartridgeOf(motor));
+		motor.velocity = direction(motor) * velocity / cartridge_scale(motor);
+		motor.current = current;
+		motor.appliedVoltage = direction(motor) * voltage;
+		motor.reportedPosition = motor.position;
+		motor.reportedVelocity = motor.velocity;
+		motor.reportedCurrent = motor.current;
+		motor.reportedVoltage = motor.appliedVoltage;
+		return 0;
+	});
+}
+
+} // namespace sim
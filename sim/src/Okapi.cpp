@@ -0,0 +1,253 @@
+// The okapilib pieces the robot and the host tools link against. okapilib
+// only ships as a prebuilt ARM archive, so these follow its sources. Timers
+// and rates go through pros::millis and task_delay_until, so they run on
+// the simulator's virtual clock.
+#include "okapi/api/control/util/settledUtil.hpp"
+#include "okapi/api/filter/composableFilter.hpp"
+#include "okapi/api/filter/demaFilter.hpp"
+#include "okapi/api/filter/emaFilter.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include "okapi/impl/util/rate.hpp"
+#include "okapi/impl/util/timeUtilFactory.hpp"
+#include "okapi/impl/util/timer.hpp"
+
+namespace okapi {
+
+Filter::~Filter() = default;
+
+EmaFilter::EmaFilter(const double ialpha) : alpha(ialpha) {}
+
+double EmaFilter::filter(const double ireading) {
+  output = alpha * ireading + (1.0 - alpha) * lastOutput;
+  lastOutput = output;
+  return output;
+}
+
+double EmaFilter::getOutput() const {
+  return output;
+}
+
+void EmaFilter::setGains(const double ialpha) {
+  alpha = ialpha;
+}
+
+ComposableFilter::ComposableFilter(const std::initializer_list<std::shared_ptr<Filter>> &ilist)
+  : filters(ilist) {
+}
+
+double ComposableFilter::filter(const double ireading) {
+  output = ireading;
+  for (auto &filter : filters) {
+    output = filter->filter(output);
+  }
+  return output;
+}
+
+double ComposableFilter::getOutput() const {
+  return output;
+}
+
+void ComposableFilter::addFilter(std::shared_ptr<Filter> ifilter) {
+  filters.push_back(std::move(ifilter));
+}
+
+DemaFilter::DemaFilter(const double ialpha, const double ibeta) : alpha(ialpha), beta(ibeta) {}
+
+double DemaFilter::filter(const double ireading) {
+  outputS = (alpha * ireading) + ((1.0 - alpha) * (lastOutputS + lastOutputB));
+  outputB = (beta * (outputS - lastOutputS)) + ((1.0 - beta) * lastOutputB);
+  lastOutputS = outputS;
+  lastOutputB = outputB;
+  return outputS + outputB;
+}
+
+double DemaFilter::getOutput() const {
+  return outputS + outputB;
+}
+
+void DemaFilter::setGains(const double ialpha, const double ibeta) {
+  alpha = ialpha;
+  beta = ibeta;
+}
+
+AbstractTimer::AbstractTimer(const QTime ifirstCalled)
+  : firstCalled(ifirstCalled), lastCalled(ifirstCalled), mark(ifirstCalled) {
+}
+
+AbstractTimer::~AbstractTimer() = default;
+
+QTime AbstractTimer::getDt() {
+  const QTime currTime = millis();
+  const QTime dt = currTime - lastCalled;
+  lastCalled = currTime;
+  return dt;
+}
+
+QTime AbstractTimer::readDt() const {
+  return millis() - lastCalled;
+}
+
+QTime AbstractTimer::getStartingTime() const {
+  return firstCalled;
+}
+
+QTime AbstractTimer::getDtFromStart() const {
+  return millis() - firstCalled;
+}
+
+void AbstractTimer::placeMark() {
+  mark = millis();
+}
+
+QTime AbstractTimer::clearMark() {
+  const QTime old = mark;
+  mark = 0_ms;
+  return old;
+}
+
+void AbstractTimer::placeHardMark() {
+  if (hardMark == 0_ms) {
+    hardMark = millis();
+  }
+}
+
+QTime AbstractTimer::clearHardMark() {
+  const QTime old = hardMark;
+  hardMark = 0_ms;
+  return old;
+}
+
+QTime AbstractTimer::getDtFromMark() const {
+  return mark != 0_ms ? millis() - mark : 0_ms;
+}
+
+QTime AbstractTimer::getDtFromHardMark() const {
+  return hardMark != 0_ms ? millis() - hardMark : 0_ms;
+}
+
+bool AbstractTimer::repeat(const QTime time) {
+  if (repeatMark == 0_ms) {
+    repeatMark = millis();
+    return false;
+  }
+
+  if (millis() - repeatMark >= time) {
+    repeatMark = 0_ms;
+    return true;
+  }
+
+  return false;
+}
+
+bool AbstractTimer::repeat(const QFrequency frequency) {
+  return repeat(QTime(1 / frequency.convert(Hz)));
+}
+
+Timer::Timer() : AbstractTimer(pros::millis() * millisecond) {
+}
+
+QTime Timer::millis() const {
+  return pros::millis() * millisecond;
+}
+
+AbstractRate::~AbstractRate() = default;
+
+Rate::Rate() = default;
+
+void Rate::delay(const QFrequency ihz) {
+  delayUntil(static_cast<uint32_t>(1000 / ihz.convert(Hz)));
+}
+
+void Rate::delayUntil(const QTime itime) {
+  delayUntil(static_cast<uint32_t>(itime.convert(millisecond)));
+}
+
+void Rate::delayUntil(const uint32_t ims) {
+  if (lastTime == 0) {
+    lastTime = pros::millis();
+  }
+  pros::c::task_delay_until(&lastTime, ims);
+}
+
+SettledUtil::SettledUtil(std::unique_ptr<AbstractTimer> iatTargetTimer,
+                         const double iatTargetError,
+                         const double iatTargetDerivative,
+                         const QTime iatTargetTime)
+  : atTargetError(iatTargetError),
+    atTargetDerivative(iatTargetDerivative),
+    atTargetTime(iatTargetTime),
+    atTargetTimer(std::move(iatTargetTimer)) {
+}
+
+SettledUtil::~SettledUtil() = default;
+
+bool SettledUtil::isSettled(const double ierror) {
+  if (std::fabs(ierror) <= atTargetError && std::fabs(ierror - lastError) <= atTargetDerivative) {
+    atTargetTimer->placeHardMark();
+  } else {
+    atTargetTimer->clearHardMark();
+  }
+
+  lastError = ierror;
+
+  return atTargetTimer->getDtFromHardMark() > atTargetTime;
+}
+
+void SettledUtil::reset() {
+  atTargetTimer->clearHardMark();
+  lastError = 0;
+}
+
+TimeUtil::TimeUtil(const Supplier<std::unique_ptr<AbstractTimer>> &itimerSupplier,
+                   const Supplier<std::unique_ptr<AbstractRate>> &irateSupplier,
+                   const Supplier<std::unique_ptr<SettledUtil>> &isettledUtilSupplier)
+  : timerSupplier(itimerSupplier),
+    rateSupplier(irateSupplier),
+    settledUtilSupplier(isettledUtilSupplier) {
+}
+
+std::unique_ptr<AbstractTimer> TimeUtil::getTimer() const {
+  return timerSupplier.get();
+}
+
+std::unique_ptr<AbstractRate> TimeUtil::getRate() const {
+  return rateSupplier.get();
+}
+
+std::unique_ptr<SettledUtil> TimeUtil::getSettledUtil() const {
+  return settledUtilSupplier.get();
+}
+
+Supplier<std::unique_ptr<AbstractTimer>> TimeUtil::getTimerSupplier() const {
+  return timerSupplier;
+}
+
+Supplier<std::unique_ptr<AbstractRate>> TimeUtil::getRateSupplier() const {
+  return rateSupplier;
+}
+
+Supplier<std::unique_ptr<SettledUtil>> TimeUtil::getSettledUtilSupplier() const {
+  return settledUtilSupplier;
+}
+
+TimeUtil TimeUtilFactory::create() {
+  return createDefault();
+}
+
+TimeUtil TimeUtilFactory::createDefault() {
+  return withSettledUtilParams();
+}
+
+TimeUtil TimeUtilFactory::withSettledUtilParams(const double iatTargetError,
+                                                const double iatTargetDerivative,
+                                                const QTime &iatTargetTime) {
+  return TimeUtil(
+    Supplier<std::unique_ptr<AbstractTimer>>([]() { return std::make_unique<Timer>(); }),
+    Supplier<std::unique_ptr<AbstractRate>>([]() { return std::make_unique<Rate>(); }),
+    Supplier<std::unique_ptr<SettledUtil>>([=]() {
+      return std::make_unique<SettledUtil>(
+        std::make_unique<Timer>(), iatTargetError, iatTargetDerivative, iatTargetTime);
+    }));
+}
+
+} // namespace okapi
@@ -0,0 +1,484 @@
+// pros/rtos.h and pros/rtos.hpp on a deterministic scheduler.
+//
+// Every task is a host thread, but only the one holding the baton runs, like
+// a single core RTOS. The baton moves only when the running task blocks
+// (delay, mutex, notification, join) or readies a higher priority task. The
+// next task is the highest priority ready one, oldest first. When none is
+// ready the clock jumps to the earliest timed wake up.
+#include "api.h"
+#include "sim/Sim.h"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t NEVER = UINT64_MAX;
+
+struct SimTask {
+	std::string name;
+	uint32_t priority = TASK_PRIORITY_DEFAULT;
+	std::condition_variable turn; // signalled when this task gets the baton
+
+	// blocked until wake (microseconds) or until ready() holds
+	uint64_t wake = 0;
+	std::function<bool()> ready;
+	uint64_t queued = 0; // order it blocked in, oldest runs first
+
+	uint32_t notifyValue = 0;
+	bool suspended = false;
+	bool deleted = false;
+	bool finished = false;
+};
+
+struct SimMutex {
+	SimTask* owner = nullptr;
+};
+
+std::mutex lock;
+uint64_t now = 0;
+uint64_t queue_order = 0;
+SimTask main_task{"main"};
+SimTask* running = &main_task;
+std::vector<SimTask*> tasks{&main_task};
+thread_local SimTask* current_task = &main_task;
+
+SimTask* resolve(pros::task_t task) {
+	return task == nullptr ? current_task : static_cast<SimTask*>(task);
+}
+
+bool runnable(SimTask* task) {
+	if (task->finished || (task->suspended && !task->deleted)) {
+		return false;
+	}
+	return task->deleted || now >= task->wake || (task->ready && task->ready());
+}
+
+SimTask* highest_ready() {
+	SimTask* best = nullptr;
+	for (SimTask* task : tasks) {
+		if (runnable(task) &&
+		    (!best || task->priority > best->priority ||
+		     (task->priority == best->priority && task->queued < best->queued))) {
+			best = task;
+		}
+	}
+	return best;
+}
+
+// the next task to run, moving the clock forward until one is ready
+SimTask* next_task() {
+	while (true) {
+		SimTask* next = highest_ready();
+		if (next) {
+			return next;
+		}
+		uint64_t wake = NEVER;
+		for (SimTask* task : tasks) {
+			if (!task->finished && !task->suspended) {
+				wake = std::min(wake, task->wake);
+			}
+		}
+		if (wake == NEVER) {
+			fprintf(stderr, "sim: every task is blocked with no timeout at %.3f s\n", now / 1e6);
+			fflush(stdout);
+			_exit(1);
+		}
+		sim::advancePhysics(wake);
+		now = wake;
+	}
+}
+
+// Hand the baton to the next task and wait to get it back. Returns at once
+// if the caller is still the best choice.
+void switch_away(std::unique_lock<std::mutex>& guard) {
+	SimTask* self = current_task;
+	self->queued = queue_order++;
+	running = next_task();
+	if (running != self) {
+		running->turn.notify_one();
+		self->turn.wait(guard, [self] { return running == self; });
+	}
+}
+
+// A deleted task stops here, still holding whatever it held, as on the RTOS
+void checkpoint(std::unique_lock<std::mutex>& guard) {
+	SimTask* self = current_task;
+	if (self->deleted) {
+		self->finished = true;
+		running = next_task();
+		running->turn.notify_one();
+		self->turn.wait(guard, [] { return false; });
+	}
+}
+
+// Block the current task until time wake or until ready() holds
+void block(std::unique_lock<std::mutex>& guard, uint64_t wake, std::function<bool()> ready = nullptr) {
+	SimTask* self = current_task;
+	self->wake = wake;
+	self->ready = std::move(ready);
+	switch_away(guard);
+	self->wake = 0;
+	self->ready = nullptr;
+	checkpoint(guard);
+}
+
+// let a task that was just readied run if it outranks the current one
+void preempt(std::unique_lock<std::mutex>& guard) {
+	SimTask* best = highest_ready();
+	if (best && best->priority > current_task->priority) {
+		block(guard, now);
+	}
+}
+
+uint64_t deadline(uint32_t timeout) {
+	return timeout == TIMEOUT_MAX ? NEVER : now + (uint64_t) timeout * 1000;
+}
+
+} // namespace
+
+namespace sim {
+
+uint64_t micros() {
+	std::lock_guard<std::mutex> guard(lock);
+	return now;
+}
+
+} // namespace sim
+
+namespace pros {
+namespace c {
+
+uint32_t millis(void) {
+	return (uint32_t) (sim::micros() / 1000);
+}
+
+uint64_t micros(void) {
+	return sim::micros();
+}
+
+task_t task_create(task_fn_t function, void* const parameters, uint32_t prio, const uint16_t stack_depth,
+                   const char* const name) {
+	std::unique_lock<std::mutex> guard(lock);
+	SimTask* task = new SimTask();
+	task->name = name ? name : "";
+	task->priority = prio;
+	task->queued = queue_order++;
+	tasks.push_back(task);
+	std::thread([task, function, parameters] {
+		current_task = task;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			task->turn.wait(guard, [task] { return running == task; });
+			checkpoint(guard);
+		}
+		function(parameters);
+		std::unique_lock<std::mutex> guard(lock);
+		task->deleted = true;
+		checkpoint(guard);
+	}).detach();
+	preempt(guard);
+	return task;
+}
+
+void task_delete(task_t task) {
+	std::unique_lock<std::mutex> guard(lock);
+	SimTask* t = resolve(task);
+	if (t->finished) {
+		return;
+	}
+	t->deleted = true;
+	if (t == current_task) {
+		checkpoint(guard);
+	}
+	preempt(guard);
+}
+
+void task_delay(const uint32_t milliseconds) {
+	std::unique_lock<std::mutex> guard(lock);
+	block(guard, now + (uint64_t) milliseconds * 1000);
+}
+
+void delay(const uint32_t milliseconds) {
+	task_delay(milliseconds);
+}
+
+void task_delay_until(uint32_t* const prev_time, const uint32_t delta) {
+	std::unique_lock<std::mutex> guard(lock);
+	*prev_time += delta;
+	block(guard, (uint64_t) *prev_time * 1000);
+}
+
+uint32_t task_get_priority(task_t task) {
+	std::lock_guard<std::mutex> guard(lock);
+	return resolve(task)->priority;
+}
+
+void task_set_priority(task_t task, uint32_t prio) {
+	std::unique_lock<std::mutex> guard(lock);
+	resolve(task)->priority = prio;
+	preempt(guard);
+}
+
+task_state_e_t task_get_state(task_t task) {
+	std::lock_guard<std::mutex> guard(lock);
+	SimTask* t = resolve(task);
+	if (t->finished) {
+		return E_TASK_STATE_DELETED;
+	}
+	if (t->suspended) {
+		return E_TASK_STATE_SUSPENDED;
+	}
+	if (t == running) {
+		return E_TASK_STATE_RUNNING;
+	}
+	return runnable(t) ? E_TASK_STATE_READY : E_TASK_STATE_BLOCKED;
+}
+
+void task_suspend(task_t task) {
+	std::unique_lock<std::mutex> guard(lock);
+	SimTask* t = resolve(task);
+	t->suspended = true;
+	if (t == current_task) {
+		switch_away(guard);
+		checkpoint(guard);
+	}
+}
+
+void task_resume(task_t task) {
+	std::unique_lock<std::mutex> guard(lock);
+	resolve(task)->suspended = false;
+	preempt(guard);
+}
+
+uint32_t task_get_count(void) {
+	std::lock_guard<std::mutex> guard(lock);
+	uint32_t count = 0;
+	for (SimTask* task : tasks) {
+		count += !task->finished;
+	}
+	return count;
+}
+
+char* task_get_name(task_t task) {
+	std::lock_guard<std::mutex> guard(lock);
+	return const_cast<char*>(resolve(task)->name.c_str());
+}
+
+task_t task_get_by_name(const char* name) {
+	std::lock_guard<std::mutex> guard(lock);
+	for (SimTask* task : tasks) {
+		if (task->name == name) {
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+task_t task_get_current() {
+	return current_task;
+}
+
+uint32_t task_notify(task_t task) {
+	return task_notify_ext(task, 0, E_NOTIFY_ACTION_INCR, nullptr);
+}
+
+void task_join(task_t task) {
+	std::unique_lock<std::mutex> guard(lock);
+	SimTask* t = resolve(task);
+	block(guard, NEVER, [t] { return t->finished; });
+}
+
+uint32_t task_notify_ext(task_t task, uint32_t value, notify_action_e_t action, uint32_t* prev_value) {
+	std::unique_lock<std::mutex> guard(lock);
+	SimTask* t = resolve(task);
+	if (prev_value) {
+		*prev_value = t->notifyValue;
+	}
+	switch (action) {
+	case E_NOTIFY_ACTION_BITS:
+		t->notifyValue |= value;
+		break;
+	case E_NOTIFY_ACTION_INCR:
+		t->notifyValue++;
+		break;
+	case E_NOTIFY_ACTION_OWRITE:
+	case E_NOTIFY_ACTION_NO_OWRITE:
+		t->notifyValue = value;
+		break;
+	case E_NOTIFY_ACTION_NONE:
+		break;
+	}
+	preempt(guard);
+	return 1;
+}
+
+uint32_t task_notify_take(bool clear_on_exit, uint32_t timeout) {
+	std::unique_lock<std::mutex> guard(lock);
+	SimTask* self = current_task;
+	if (self->notifyValue == 0 && timeout > 0) {
+		block(guard, deadline(timeout), [self] { return self->notifyValue != 0; });
+	}
+	uint32_t value = self->notifyValue;
+	if (clear_on_exit) {
+		self->notifyValue = 0;
+	} else if (value > 0) {
+		self->notifyValue--;
+	}
+	return value;
+}
+
+bool task_notify_clear(task_t task) {
+	std::lock_guard<std::mutex> guard(lock);
+	SimTask* t = resolve(task);
+	bool wasPending = t->notifyValue != 0;
+	t->notifyValue = 0;
+	return wasPending;
+}
+
+mutex_t mutex_create(void) {
+	return new SimMutex();
+}
+
+bool mutex_take(mutex_t mutex, uint32_t timeout) {
+	std::unique_lock<std::mutex> guard(lock);
+	SimMutex* m = static_cast<SimMutex*>(mutex);
+	if (m->owner && timeout > 0) {
+		block(guard, deadline(timeout), [m] { return m->owner == nullptr; });
+	}
+	if (m->owner) {
+		errno = EACCES;
+		return false;
+	}
+	m->owner = current_task;
+	return true;
+}
+
+bool mutex_give(mutex_t mutex) {
+	std::unique_lock<std::mutex> guard(lock);
+	static_cast<SimMutex*>(mutex)->owner = nullptr;
+	preempt(guard);
+	return true;
+}
+
+void mutex_delete(mutex_t mutex) {
+	delete static_cast<SimMutex*>(mutex);
+}
+
+} // namespace c
+
+Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth, const char* name)
+    : task(c::task_create(function, parameters, prio, stack_depth, name)) {}
+
+Task::Task(task_fn_t function, void* parameters, const char* name)
+    : Task(function, parameters, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name) {}
+
+Task::Task(task_t task) : task(task) {}
+
+Task Task::current() {
+	return Task(c::task_get_current());
+}
+
+Task& Task::operator=(task_t in) {
+	task = in;
+	return *this;
+}
+
+void Task::remove() {
+	c::task_delete(task);
+}
+
+std::uint32_t Task::get_priority() {
+	return c::task_get_priority(task);
+}
+
+void Task::set_priority(std::uint32_t prio) {
+	c::task_set_priority(task, prio);
+}
+
+std::uint32_t Task::get_state() {
+	return c::task_get_state(task);
+}
+
+void Task::suspend() {
+	c::task_suspend(task);
+}
+
+void Task::resume() {
+	c::task_resume(task);
+}
+
+const char* Task::get_name() {
+	return c::task_get_name(task);
+}
+
+std::uint32_t Task::notify() {
+	return c::task_notify(task);
+}
+
+void Task::join() {
+	c::task_join(task);
+}
+
+std::uint32_t Task::notify_ext(std::uint32_t value, notify_action_e_t action, std::uint32_t* prev_value) {
+	return c::task_notify_ext(task, value, action, prev_value);
+}
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout) {
+	return c::task_notify_take(clear_on_exit, timeout);
+}
+
+bool Task::notify_clear() {
+	return c::task_notify_clear(task);
+}
+
+void Task::delay(const std::uint32_t milliseconds) {
+	c::task_delay(milliseconds);
+}
+
+void Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta) {
+	c::task_delay_until(prev_time, delta);
+}
+
+std::uint32_t Task::get_count() {
+	return c::task_get_count();
+}
+
+Clock::time_point Clock::now() {
+	return time_point{duration{c::millis()}};
+}
+
+Mutex::Mutex() : mutex(c::mutex_create(), c::mutex_delete) {}
+
+bool Mutex::take() {
+	return c::mutex_take(mutex.get(), TIMEOUT_MAX);
+}
+
+bool Mutex::take(std::uint32_t timeout) {
+	return c::mutex_take(mutex.get(), timeout);
+}
+
+bool Mutex::give() {
+	return c::mutex_give(mutex.get());
+}
+
+void Mutex::lock() {
+	take(TIMEOUT_MAX);
+}
+
+void Mutex::unlock() {
+	give();
+}
+
+bool Mutex::try_lock() {
+	return take(0);
+}
+
+} // namespace pros
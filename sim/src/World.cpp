@@ -0,0 +1,159 @@
+#include "sim/Sim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace sim {
+
+static std::shared_ptr<Plant> plant = std::make_shared<FreeMotorPlant>();
+static std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+static bool paced = false;
+static uint64_t physicsTime = 0; // microseconds
+
+World& world() {
+	static World instance;
+	return instance;
+}
+
+std::recursive_mutex& worldMutex() {
+	static std::recursive_mutex mutex;
+	return mutex;
+}
+
+void setPlant(std::shared_ptr<Plant> newPlant) {
+	std::lock_guard<std::recursive_mutex> lock(worldMutex());
+	plant = std::move(newPlant);
+}
+
+double maxRpm(int gearset) {
+	switch (gearset) {
+	case 0:
+		return 100;
+	case 2:
+		return 600;
+	default:
+		return 200;
+	}
+}
+
+double countsPerRev(int gearset) {
+	switch (gearset) {
+	case 0:
+		return 1800;
+	case 2:
+		return 300;
+	default:
+		return 900;
+	}
+}
+
+int cartridgeOf(const MotorState& motor) {
+	return motor.cartridge < 0 ? motor.gearset : motor.cartridge;
+}
+
+double commandedVoltage(const World& world, const MotorState& motor) {
+	// VEXos ignores motor commands while the robot is disabled
+	if (world.competitionStatus & COMPETITION_DISABLED_BIT) {
+		return 0;
+	}
+	double voltage = 0;
+	double rpm = maxRpm(cartridgeOf(motor));
+	switch (motor.mode) {
+	case MotorState::Mode::VOLTAGE:
+		voltage = motor.targetVoltage;
+		break;
+	case MotorState::Mode::VELOCITY:
+		// feedforward plus proportional, close enough to the motor's own loop
+		voltage = 12000 * motor.targetVelocity / rpm + 60 * (motor.targetVelocity - motor.velocity);
+		break;
+	case MotorState::Mode::POSITION: {
+		double limit = 12000 * std::abs(motor.targetVelocity) / rpm;
+		voltage = std::clamp(40 * (motor.targetPosition - motor.position), -limit, limit);
+		break;
+	}
+	case MotorState::Mode::BRAKE:
+		voltage = 0;
+		break;
+	}
+	double limit = motor.voltageLimit > 0 ? std::min(motor.voltageLimit, 12000) : 12000;
+	return std::clamp(voltage, -limit, limit);
+}
+
+void FreeMotorPlant::step(World& world, double dt) {
+	for (MotorState& motor : world.motors) {
+		if (motor.connected) {
+			stepMotor(world, motor, dt);
+		}
+	}
+}
+
+void FreeMotorPlant::stepMotor(const World& world, MotorState& motor, double dt) {
+	const double timeConstant = 0.08;
+	double voltage = commandedVoltage(world, motor);
+	double freeSpeed = maxRpm(cartridgeOf(motor));
+	double target = freeSpeed * voltage / 12000;
+	bool braking = voltage == 0 && (motor.mode == MotorState::Mode::BRAKE || motor.brakeMode != 0);
+	double tau = braking ? timeConstant / 4 : timeConstant;
+	motor.velocity += (target - motor.velocity) * std::min(dt / tau, 1.0);
+	motor.position += motor.velocity * 6 * dt; // rpm to degrees per second
+	motor.appliedVoltage = voltage;
+	motor.current = std::min(2500.0, std::abs(target - motor.velocity) / freeSpeed * 2500);
+}
+
+// copy the physical state into what user code can read, as the brain would
+// every DEVICE_UPDATE_MS
+static void report(World& world, uint32_t now) {
+	for (MotorState& motor : world.motors) {
+		motor.reportedPosition = motor.position;
+		motor.reportedVelocity = motor.velocity;
+		motor.reportedCurrent = motor.current;
+		motor.reportedTorque = motor.torque;
+		motor.reportedVoltage = motor.appliedVoltage;
+		motor.reportedTimestamp = now;
+	}
+	for (ImuState& imu : world.imus) {
+		imu.reportedRotation = imu.rotation + imu.drift * now / 1000;
+		imu.reportedRate = imu.rate + imu.drift;
+	}
+}
+
+void start(bool realTime) {
+	paced = realTime;
+	epoch = std::chrono::steady_clock::now();
+}
+
+void advancePhysics(uint64_t time) {
+	const uint64_t stepMicros = 1000;
+	while (physicsTime + stepMicros <= time) {
+		if (paced) {
+			std::this_thread::sleep_until(epoch + std::chrono::microseconds(physicsTime + stepMicros));
+		}
+		std::lock_guard<std::recursive_mutex> lock(worldMutex());
+		World& w = world();
+		plant->step(w, stepMicros / 1e6);
+		physicsTime += stepMicros;
+		w.time = physicsTime / 1e6;
+		if (physicsTime % (DEVICE_UPDATE_MS * 1000) == 0) {
+			report(w, (uint32_t) (physicsTime / 1000));
+		}
+	}
+}
+
+void setAnalog(int controller, int channel, int32_t value) {
+	std::lock_guard<std::recursive_mutex> lock(worldMutex());
+	world().controllers[controller].analog[channel] = std::clamp(value, -127, 127);
+}
+
+void setDigital(int controller, int button, bool pressed) {
+	std::lock_guard<std::recursive_mutex> lock(worldMutex());
+	ControllerState& state = world().controllers[controller];
+	int index = button - FIRST_DIGITAL;
+	if (pressed && !state.digital[index]) {
+		state.newPress[index] = true;
+	}
+	state.digital[index] = pressed;
+}
+
+} // namespace sim
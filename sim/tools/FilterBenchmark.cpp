@@ -0,0 +1,332 @@
+// Benchmarks okapi's filters on the host: bin/host/FilterBenchmark [--samples N]
+//
+// Each filter runs over the same deterministic signals and reports ns per
+// sample next to the implementation it replaces, after checking the outputs
+// agree: sample for sample, or within the documented tolerance. Exits non-zero
+// if any do not. Host numbers only rank implementations; the brain is several
+// times slower.
+#include "okapi/api/filter/averageFilter.hpp"
+#include "okapi/api/filter/composableFilter.hpp"
+#include "okapi/api/filter/filterBank.hpp"
+#include "okapi/api/filter/filterChain.hpp"
+#include "okapi/api/filter/medianFilter.hpp"
+#include "okapi/api/filter/runningAverageFilter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+// MedianFilter before the sorted window: quickselect over a copy of the
+// window on every reading (N. Wirth's algorithm, N. Devillard's
+// implementation, as okapi had it)
+template <std::size_t n> class QuickselectMedianFilter : public okapi::MedianFilter<n> {
+public:
+	double filter(const double ireading) override {
+		this->data[this->index++] = ireading;
+		if (this->index >= n) {
+			this->index = 0;
+		}
+		this->output = select();
+		return this->output;
+	}
+
+private:
+	double select() const {
+		std::array<double, n> copy = this->data;
+		const size_t k = this->middleIndex;
+		size_t l = 0;
+		size_t m = n - 1;
+		while (l < m) {
+			double x = copy[k];
+			size_t i = l;
+			size_t j = m;
+			do {
+				while (copy[i] < x) {
+					i++;
+				}
+				while (x < copy[j]) {
+					j--;
+				}
+				if (i <= j) {
+					std::swap(copy[i], copy[j]);
+					i++;
+					j--;
+				}
+			} while (i <= j);
+			if (j < k) {
+				l = i;
+			}
+			if (k < i) {
+				m = j;
+			}
+		}
+		return copy[k];
+	}
+};
+
+struct Signal {
+	const char* name;
+	std::vector<double> samples;
+};
+
+// a velocity-like reading with sensor noise, white noise as the worst case
+// for ordering, and a battery-like reading, small changes on a large value
+static std::vector<Signal> make_signals(size_t count) {
+	std::mt19937_64 rng(1);
+	std::normal_distribution<double> noise(0, 5);
+	std::uniform_real_distribution<double> uniform(-1000, 1000);
+	Signal sensor{"sensor", {}};
+	Signal white{"white", {}};
+	Signal battery{"battery", {}};
+	for (size_t i = 0; i < count; i++) {
+		sensor.samples.push_back(400 * std::sin(i * 0.002) + noise(rng));
+		white.samples.push_back(uniform(rng));
+		battery.samples.push_back(12800 - i * 0.01 + 4 * noise(rng));
+	}
+	return {sensor, white, battery};
+}
+
+// ns per sample through the filter's own filter(), outputs kept for comparing
+template <typename F> static double time_filter(const std::vector<double>& in, std::vector<double>& out) {
+	F filter;
+	out.resize(in.size());
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < in.size(); i++) {
+		out[i] = filter.filter(in[i]);
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double, std::nano>(elapsed).count() / in.size();
+}
+
+static bool identical(const std::vector<double>& a, const std::vector<double>& b) {
+	return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+static bool failed = false;
+
+template <std::size_t n> static void bench_median(const std::vector<Signal>& signals) {
+	std::vector<double> expected, actual;
+	for (const Signal& signal : signals) {
+		if (strcmp(signal.name, "battery") == 0) {
+			continue;
+		}
+		double before = time_filter<QuickselectMedianFilter<n>>(signal.samples, expected);
+		double after = time_filter<okapi::MedianFilter<n>>(signal.samples, actual);
+		bool same = identical(expected, actual);
+		failed |= !same;
+		printf("%-8zu %-8s %12.1f %12.1f %8.1fx %s\n", n, signal.name, before, after, before / after,
+		       same ? "" : "MISMATCH");
+	}
+}
+
+template <std::size_t... sizes> static void bench_medians(const std::vector<Signal>& signals) {
+	printf("MedianFilter<n>, ns per sample\n");
+	printf("%-8s %-8s %12s %12s %9s\n", "n", "signal", "quickselect", "sorted", "speedup");
+	(bench_median<sizes>(signals), ...);
+}
+
+// RunningAverageFilter must match AverageFilter exactly every n readings and
+// stay within its documented bound in between
+template <std::size_t n> static void bench_average(const std::vector<Signal>& signals) {
+	std::vector<double> expected, actual;
+	for (const Signal& signal : signals) {
+		double before = time_filter<okapi::AverageFilter<n>>(signal.samples, expected);
+		double after = time_filter<okapi::RunningAverageFilter<n>>(signal.samples, actual);
+		double largest = 0;
+		for (double sample : signal.samples) {
+			largest = std::max(largest, std::abs(sample));
+		}
+		double bound = (n + 6) * DBL_EPSILON * largest;
+		double worst = 0;
+		bool resynced = true;
+		for (size_t i = 0; i < expected.size(); i++) {
+			worst = std::max(worst, std::abs(expected[i] - actual[i]));
+			resynced &= (i + 1) % n != 0 || expected[i] == actual[i];
+		}
+		bool same = resynced && worst <= bound;
+		failed |= !same;
+		printf("%-8zu %-8s %12.1f %12.1f %8.1fx %10.3f %s\n", n, signal.name, before, after, before / after,
+		       worst / bound, same ? "" : "OUT OF TOLERANCE");
+	}
+}
+
+template <std::size_t... sizes> static void bench_averages(const std::vector<Signal>& signals) {
+	printf("AverageFilter<n>, ns per sample; error is the worst difference over the documented bound\n");
+	printf("%-8s %-8s %12s %12s %9s %10s\n", "n", "signal", "summed", "running", "speedup", "error");
+	(bench_average<sizes>(signals), ...);
+}
+
+static constexpr std::size_t BANK_CHANNELS = 9; // a motor signal on every motor
+
+// FilterBank against one heap allocated scalar filter per channel, each
+// channel a different stretch of the sensor signal
+template <typename Bank>
+static void bench_bank(const char* name, const Signal& signal, std::function<std::unique_ptr<okapi::Filter>()> make,
+                       Bank bank) {
+	size_t steps = signal.samples.size() / BANK_CHANNELS;
+	std::vector<typename Bank::Readings> in(steps);
+	for (size_t t = 0; t < steps; t++) {
+		for (size_t i = 0; i < BANK_CHANNELS; i++) {
+			in[t][i] = signal.samples[i * steps + t];
+		}
+	}
+
+	std::vector<std::unique_ptr<okapi::Filter>> filters;
+	for (size_t i = 0; i < BANK_CHANNELS; i++) {
+		filters.push_back(make());
+	}
+	std::vector<typename Bank::Readings> expected(steps), actual(steps);
+	auto start = std::chrono::steady_clock::now();
+	for (size_t t = 0; t < steps; t++) {
+		for (size_t i = 0; i < BANK_CHANNELS; i++) {
+			expected[t][i] = filters[i]->filter(in[t][i]);
+		}
+	}
+	auto middle = std::chrono::steady_clock::now();
+	for (size_t t = 0; t < steps; t++) {
+		actual[t] = bank.filter(in[t]);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double before = std::chrono::duration<double, std::nano>(middle - start).count() / steps;
+	double after = std::chrono::duration<double, std::nano>(end - middle).count() / steps;
+	bool same = memcmp(expected.data(), actual.data(), steps * sizeof(typename Bank::Readings)) == 0;
+	failed |= !same;
+	printf("%-16s %12.1f %12.1f %8.1fx %s\n", name, before, after, before / after, same ? "" : "MISMATCH");
+}
+
+static void bench_banks(const std::vector<Signal>& signals) {
+	using namespace okapi;
+	const Signal& signal = signals[0];
+	printf("FilterBank<Kind, %zu>, ns per tick for all channels\n", BANK_CHANNELS);
+	printf("%-16s %12s %12s %9s\n", "kind", "scalar", "bank", "speedup");
+	bench_bank("EmaFilter", signal, [] { return std::make_unique<EmaFilter>(0.2); },
+	           FilterBank<EmaFilter, BANK_CHANNELS>(0.2));
+	bench_bank("DemaFilter", signal, [] { return std::make_unique<DemaFilter>(0.2, 0.05); },
+	           FilterBank<DemaFilter, BANK_CHANNELS>(0.2, 0.05));
+	bench_bank("AverageFilter<5>", signal, [] { return std::make_unique<AverageFilter<5>>(); },
+	           FilterBank<AverageFilter<5>, BANK_CHANNELS>());
+	bench_bank("MedianFilter<5>", signal, [] { return std::make_unique<MedianFilter<5>>(); },
+	           FilterBank<MedianFilter<5>, BANK_CHANNELS>());
+	bench_bank("MedianFilter<9>", signal, [] { return std::make_unique<MedianFilter<9>>(); },
+	           FilterBank<MedianFilter<9>, BANK_CHANNELS>());
+	bench_bank("MedianFilter<21>", signal, [] { return std::make_unique<MedianFilter<21>>(); },
+	           FilterBank<MedianFilter<21>, BANK_CHANNELS>());
+}
+
+// FilterChain against ComposableFilter with the same stages
+template <typename Chain>
+static void bench_chain(const char* name, const Signal& signal, okapi::ComposableFilter composable, Chain chain) {
+	std::vector<double> expected(signal.samples.size()), actual(signal.samples.size());
+	// through the Filter interface, as a ComposableFilter is used
+	okapi::Filter& composableFilter = composable;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < signal.samples.size(); i++) {
+		expected[i] = composableFilter.filter(signal.samples[i]);
+	}
+	auto middle = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < signal.samples.size(); i++) {
+		actual[i] = chain.filter(signal.samples[i]);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double before = std::chrono::duration<double, std::nano>(middle - start).count() / signal.samples.size();
+	double after = std::chrono::duration<double, std::nano>(end - middle).count() / signal.samples.size();
+	bool same = identical(expected, actual);
+	failed |= !same;
+	printf("%-34s %12.1f %12.1f %8.1fx %s\n", name, before, after, before / after, same ? "" : "MISMATCH");
+}
+
+static void bench_chains(const std::vector<Signal>& signals) {
+	using namespace okapi;
+	const Signal& signal = signals[0];
+	printf("FilterChain<...>, ns per sample\n");
+	printf("%-34s %12s %12s %9s\n", "stages", "composable", "chain", "speedup");
+	bench_chain("Average<3>, Average<3>", signal,
+	            ComposableFilter({std::make_shared<AverageFilter<3>>(), std::make_shared<AverageFilter<3>>()}),
+	            FilterChain<AverageFilter<3>, AverageFilter<3>>());
+	bench_chain("Median<5>, Ema", signal,
+	            ComposableFilter({std::make_shared<MedianFilter<5>>(), std::make_shared<EmaFilter>(0.2)}),
+	            FilterChain(MedianFilter<5>(), EmaFilter(0.2)));
+	bench_chain("Median<5>, Ema, Dema, Average<4>", signal,
+	            ComposableFilter({std::make_shared<MedianFilter<5>>(), std::make_shared<EmaFilter>(0.2),
+	                              std::make_shared<DemaFilter>(0.3, 0.1), std::make_shared<AverageFilter<4>>()}),
+	            FilterChain(MedianFilter<5>(), EmaFilter(0.2), DemaFilter(0.3, 0.1), AverageFilter<4>()));
+}
+
+// block filter() against a virtual filter() call per value, as a log
+// analysis tool holding a Filter reference would run it
+template <typename F> static void bench_block(const char* name, const Signal& signal, F streaming, F block) {
+	std::vector<double> expected(signal.samples.size()), actual(signal.samples.size());
+	okapi::Filter& filter = streaming;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < signal.samples.size(); i++) {
+		expected[i] = filter.filter(signal.samples[i]);
+	}
+	// in place, in blocks of awkward sizes so state carries across blocks
+	actual = signal.samples;
+	static const size_t sizes[] = {1, 5, 63, 64, 65, 4096};
+	auto middle = std::chrono::steady_clock::now();
+	for (size_t i = 0, k = 0; i < actual.size(); k++) {
+		size_t count = std::min(sizes[k % 6], actual.size() - i);
+		okapi::filterBlock(block, actual.data() + i, actual.data() + i, count);
+		i += count;
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double before = std::chrono::duration<double, std::nano>(middle - start).count() / signal.samples.size();
+	double after = std::chrono::duration<double, std::nano>(end - middle).count() / signal.samples.size();
+	bool same = identical(expected, actual) && streaming.getOutput() == block.getOutput();
+	failed |= !same;
+	printf("%-34s %12.2f %12.2f %8.1fx %s\n", name, before, after, before / after, same ? "" : "MISMATCH");
+}
+
+static void bench_blocks(const std::vector<Signal>& signals) {
+	using namespace okapi;
+	const Signal& signal = signals[0];
+	printf("block filter(), ns per sample\n");
+	printf("%-34s %12s %12s %9s\n", "filter", "per value", "block", "speedup");
+	bench_block("EmaFilter", signal, EmaFilter(0.2), EmaFilter(0.2));
+	bench_block("DemaFilter", signal, DemaFilter(0.2, 0.05), DemaFilter(0.2, 0.05));
+	bench_block("AverageFilter<5>", signal, AverageFilter<5>(), AverageFilter<5>());
+	bench_block("RunningAverageFilter<50>", signal, RunningAverageFilter<50>(), RunningAverageFilter<50>());
+	bench_block("MedianFilter<5>", signal, MedianFilter<5>(), MedianFilter<5>());
+	bench_block("MedianFilter<21>", signal, MedianFilter<21>(), MedianFilter<21>());
+	bench_block("Median<5>, Ema, Dema, Average<4>", signal,
+	            FilterChain(MedianFilter<5>(), EmaFilter(0.2), DemaFilter(0.3, 0.1), AverageFilter<4>()),
+	            FilterChain(MedianFilter<5>(), EmaFilter(0.2), DemaFilter(0.3, 0.1), AverageFilter<4>()));
+}
+
+int main(int argc, char** argv) {
+	size_t samples = 200000;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+			samples = strtoul(argv[++i], nullptr, 10);
+		} else {
+			fprintf(stderr, "usage: %s [--samples N]\n", argv[0]);
+			return 2;
+		}
+	}
+	std::vector<Signal> signals = make_signals(samples);
+
+	bench_medians<5, 11, 21, 31, 51, 75, 101>(signals);
+	printf("\n");
+	bench_averages<5, 20, 100, 500, 2000>(signals);
+	printf("\n");
+	bench_banks(signals);
+	printf("\n");
+	bench_chains(signals);
+	printf("\n");
+	bench_blocks(signals);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,371 @@
+// Monte Carlo evaluation of autonomous(): bin/host/MonteCarlo [options]
+//
+//   --runs N                 perturbed runs (default 1000)
+//   --jobs N                 runs at a time (default one per CPU)
+//   --seed N                 run i gets the same perturbation for the same seed
+//   --strength SD            spread of each drive motor's torque, as a fraction (default 0.05)
+//   --traction SD            spread of tire friction per run, as a fraction (default 0.15)
+//   --drift SD               spread of IMU bias in deg/s (default 0.02)
+//   --start SD               spread of the start position in inches (default 0.5)
+//   --start-heading SD       spread of the start heading in degrees (default 1)
+//   --tolerance IN           end position miss that counts as a failure (default 6)
+//   --heading-tolerance DEG  end heading miss that counts as a failure (default 10)
+//   --time SECONDS           autonomous period (default 15)
+//   --csv FILE               write one line per run
+//
+// Every run is a forked copy of the host build going through initialize()
+// and autonomous() like bin/host/robot auton, on its own virtual clock, so
+// runs are independent and use every core. Run 0 is unperturbed; the others
+// are scored against where it ended. A run fails if autonomous() is still
+// going when the period ends, if it ends out of tolerance, or if the
+// simulated brain dies (a deadlock, a crash).
+#include "main.h"
+#include "Command.h"
+#include "sim/DrivetrainSimulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+extern CommandPtr autonomous_routine;
+
+static constexpr int MAX_STEPS = 32;
+
+struct Options {
+	int runs = 1000;
+	int jobs = 0;
+	uint64_t seed = 1;
+	double strength = 0.05;
+	double traction = 0.15;
+	double drift = 0.02;
+	double start = 0.5;
+	double startHeading = 1;
+	double tolerance = 6;
+	double headingTolerance = 10;
+	double seconds = 15;
+	const char* csv = nullptr;
+};
+
+// What a run sends back over its pipe; small enough to write atomically
+struct RunResult {
+	int32_t run;
+	uint8_t finished; // autonomous() returned within the period
+	double x;
+	double y;
+	double heading;
+	uint32_t time; // ms autonomous() ran
+	uint32_t stepCount;
+	uint32_t steps[MAX_STEPS]; // ms per step of the routine
+};
+
+enum Status { OK, TIMEOUT, OFF_TARGET, CRASHED, NUM_STATUSES };
+static const char* STATUS_NAMES[NUM_STATUSES] = {"ok", "timeout", "off target", "crashed"};
+
+static void usage(const char* name) {
+	fprintf(stderr,
+	        "usage: %s [--runs N] [--jobs N] [--seed N] [--strength SD] [--traction SD] [--drift SD] [--start SD]"
+	        " [--start-heading SD] [--tolerance IN] [--heading-tolerance DEG] [--time SECONDS] [--csv FILE]\n",
+	        name);
+	exit(2);
+}
+
+static bool imus_calibrating() {
+	std::lock_guard<std::recursive_mutex> lock(sim::worldMutex());
+	for (const sim::ImuState& imu : sim::world().imus) {
+		if (imu.connected && pros::millis() < imu.calibratedAt) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// The drivetrain and IMU bias for a run; run 0 is the robot as configured
+static sim::DrivetrainSimulator::Config perturb(const Options& options, int run, double* drift) {
+	sim::DrivetrainSimulator::Config config = sim::robotDrivetrain();
+	*drift = 0;
+	if (run == 0) {
+		return config;
+	}
+	std::seed_seq seed{(uint32_t) options.seed, (uint32_t) (options.seed >> 32), (uint32_t) run};
+	std::mt19937_64 rng(seed);
+	std::normal_distribution<double> normal;
+	for (auto* side : {&config.left, &config.right}) {
+		for (sim::DrivetrainSimulator::Mount& mount : *side) {
+			mount.strength = std::max(0.1, 1 + options.strength * normal(rng));
+		}
+	}
+	config.traction *= std::max(0.1, 1 + options.traction * normal(rng));
+	*drift = options.drift * normal(rng);
+	config.start.x += options.start * normal(rng);
+	config.start.y += options.start * normal(rng);
+	config.start.heading += options.startHeading * normal(rng);
+	return config;
+}
+
+// Runs in the forked child: one autonomous period, result to fd
+[[noreturn]] static void run_child(const Options& options, int run, int fd) {
+	double drift;
+	auto drivetrain = std::make_shared<sim::DrivetrainSimulator>(perturb(options, run, &drift));
+	drivetrain->install(sim::world());
+	sim::setPlant(drivetrain);
+	for (sim::ImuState& imu : sim::world().imus) {
+		imu.drift = drift;
+	}
+	sim::world().competitionStatus = COMPETITION_DISABLED;
+	sim::start();
+	initialize();
+	competition_initialize();
+	while (imus_calibrating()) {
+		pros::delay(10);
+	}
+
+	sim::world().competitionStatus = COMPETITION_AUTONOMOUS;
+	uint32_t start = pros::millis();
+	pros::Task mode([] { autonomous(); }, "mode");
+	while (pros::millis() - start < options.seconds * 1000 && mode.get_state() != pros::E_TASK_STATE_DELETED) {
+		pros::delay(10);
+	}
+
+	RunResult result = {};
+	result.run = run;
+	result.finished = mode.get_state() == pros::E_TASK_STATE_DELETED;
+	result.time = pros::millis() - start;
+	sim::DrivetrainSimulator::Pose pose = drivetrain->getPose();
+	result.x = pose.x;
+	result.y = pose.y;
+	result.heading = pose.heading;
+	if (auto routine = std::dynamic_pointer_cast<SequentialGroup>(autonomous_routine)) {
+		const std::vector<uint32_t>& steps = routine->getStepTimes();
+		result.stepCount = std::min((uint32_t) steps.size(), (uint32_t) MAX_STEPS);
+		std::copy(steps.begin(), steps.begin() + result.stepCount, result.steps);
+	}
+	write(fd, &result, sizeof(result));
+	_exit(0);
+}
+
+// Every run's result, indexed by run; valid is false for runs that crashed
+static std::vector<RunResult> run_all(const Options& options, std::vector<bool>& valid) {
+	std::vector<RunResult> results(options.runs + 1);
+	valid.assign(options.runs + 1, false);
+	struct Child {
+		int run;
+		int fd;
+	};
+	std::map<pid_t, Child> children;
+	int next = 0;
+	fflush(stdout);
+	fflush(stderr);
+	while (next <= options.runs || !children.empty()) {
+		while ((int) children.size() < options.jobs && next <= options.runs) {
+			int fds[2];
+			if (pipe(fds) != 0) {
+				perror("pipe");
+				exit(1);
+			}
+			pid_t pid = fork();
+			if (pid < 0) {
+				perror("fork");
+				exit(1);
+			}
+			if (pid == 0) {
+				close(fds[0]);
+				run_child(options, next, fds[1]);
+			}
+			close(fds[1]);
+			children[pid] = {next++, fds[0]};
+		}
+
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		auto child = children.find(pid);
+		if (child == children.end()) {
+			continue;
+		}
+		RunResult& result = results[child->second.run];
+		valid[child->second.run] = WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+		                           read(child->second.fd, &result, sizeof(result)) == sizeof(result);
+		close(child->second.fd);
+		children.erase(child);
+	}
+	return results;
+}
+
+static double wrap_degrees(double angle) {
+	angle = std::fmod(angle, 360);
+	return angle <= -180 ? angle + 360 : angle > 180 ? angle - 360 : angle;
+}
+
+// nearest rank, values sorted
+static double percentile(const std::vector<double>& values, double p) {
+	size_t rank = (size_t) std::ceil(p / 100 * values.size());
+	return values[std::clamp(rank, (size_t) 1, values.size()) - 1];
+}
+
+static void print_distribution(const char* name, std::vector<double> values) {
+	if (values.empty()) {
+		return;
+	}
+	std::sort(values.begin(), values.end());
+	double mean = 0;
+	for (double value : values) {
+		mean += value;
+	}
+	mean /= values.size();
+	double variance = 0;
+	for (double value : values) {
+		variance += (value - mean) * (value - mean);
+	}
+	double sd = values.size() > 1 ? std::sqrt(variance / (values.size() - 1)) : 0;
+	printf("%-14s %8.2f %8.2f %8.2f %8.2f %8.2f\n", name, mean, sd, percentile(values, 5), percentile(values, 50),
+	       percentile(values, 95));
+}
+
+static void print_times(const char* name, std::vector<double> times) {
+	if (times.empty()) {
+		return;
+	}
+	std::sort(times.begin(), times.end());
+	printf("%-6s %6zu %8.0f %8.0f %8.0f %8.0f\n", name, times.size(), percentile(times, 50), percentile(times, 90),
+	       percentile(times, 99), times.back());
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+		}
+		const char* value = argv[++i];
+		if (strcmp(arg, "--runs") == 0) {
+			options.runs = atoi(value);
+		} else if (strcmp(arg, "--jobs") == 0) {
+			options.jobs = atoi(value);
+		} else if (strcmp(arg, "--seed") == 0) {
+			options.seed = strtoull(value, nullptr, 10);
+		} else if (strcmp(arg, "--strength") == 0) {
+			options.strength = atof(value);
+		} else if (strcmp(arg, "--traction") == 0) {
+			options.traction = atof(value);
+		} else if (strcmp(arg, "--drift") == 0) {
+			options.drift = atof(value);
+		} else if (strcmp(arg, "--start") == 0) {
+			options.start = atof(value);
+		} else if (strcmp(arg, "--start-heading") == 0) {
+			options.startHeading = atof(value);
+		} else if (strcmp(arg, "--tolerance") == 0) {
+			options.tolerance = atof(value);
+		} else if (strcmp(arg, "--heading-tolerance") == 0) {
+			options.headingTolerance = atof(value);
+		} else if (strcmp(arg, "--time") == 0) {
+			options.seconds = atof(value);
+		} else if (strcmp(arg, "--csv") == 0) {
+			options.csv = value;
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (options.jobs <= 0) {
+		options.jobs = std::max(1u, std::thread::hardware_concurrency());
+	}
+	options.runs = std::max(options.runs, 0);
+
+	auto wallStart = std::chrono::steady_clock::now();
+	std::vector<bool> valid;
+	std::vector<RunResult> results = run_all(options, valid);
+	double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+	if (!valid[0]) {
+		fprintf(stderr, "the unperturbed run crashed\n");
+		return 1;
+	}
+	const RunResult& nominal = results[0];
+	printf("nominal: x %.2f in, y %.2f in, heading %.2f deg, %s after %.3f s\n", nominal.x, nominal.y,
+	       nominal.heading, nominal.finished ? "finished" : "timed out", nominal.time / 1000.0);
+	printf("%d runs on %d jobs in %.1f s\n\n", options.runs, options.jobs, wallTime);
+
+	FILE* csv = options.csv ? fopen(options.csv, "w") : nullptr;
+	if (options.csv && !csv) {
+		perror(options.csv);
+	}
+	if (csv) {
+		fprintf(csv, "run,status,x,y,heading,time_ms");
+		for (uint32_t i = 0; i < nominal.stepCount; i++) {
+			fprintf(csv, ",step%u_ms", i + 1);
+		}
+		fprintf(csv, "\n");
+	}
+
+	std::vector<double> xs, ys, headings, misses, totals;
+	std::vector<std::vector<double>> steps(MAX_STEPS);
+	int counts[NUM_STATUSES] = {};
+	for (int run = 1; run <= options.runs; run++) {
+		const RunResult& result = results[run];
+		Status status = CRASHED;
+		if (valid[run]) {
+			double miss = std::hypot(result.x - nominal.x, result.y - nominal.y);
+			double headingMiss = wrap_degrees(result.heading - nominal.heading);
+			if (!result.finished) {
+				status = TIMEOUT;
+			} else if (miss > options.tolerance || std::abs(headingMiss) > options.headingTolerance) {
+				status = OFF_TARGET;
+			} else {
+				status = OK;
+			}
+			xs.push_back(result.x);
+			ys.push_back(result.y);
+			headings.push_back(nominal.heading + headingMiss);
+			misses.push_back(miss);
+			if (result.finished) {
+				totals.push_back(result.time);
+			}
+			for (uint32_t i = 0; i < result.stepCount; i++) {
+				steps[i].push_back(result.steps[i]);
+			}
+		}
+		counts[status]++;
+
+		if (csv) {
+			fprintf(csv, "%d,%s,%.3f,%.3f,%.3f,%u", run, STATUS_NAMES[status], result.x, result.y, result.heading,
+			        result.time);
+			for (uint32_t i = 0; i < result.stepCount; i++) {
+				fprintf(csv, ",%u", result.steps[i]);
+			}
+			fprintf(csv, "\n");
+		}
+	}
+	if (csv) {
+		fclose(csv);
+	}
+
+	printf("%-14s %8s %8s %8s %8s %8s\n", "end pose", "mean", "sd", "p5", "p50", "p95");
+	print_distribution("x (in)", xs);
+	print_distribution("y (in)", ys);
+	print_distribution("heading (deg)", headings);
+	print_distribution("miss (in)", misses);
+
+	printf("\n%-6s %6s %8s %8s %8s %8s\n", "step", "runs", "p50_ms", "p90_ms", "p99_ms", "max_ms");
+	char name[16];
+	for (int i = 0; i < MAX_STEPS; i++) {
+		snprintf(name, sizeof(name), "%d", i + 1);
+		print_times(name, steps[i]);
+	}
+	print_times("total", totals);
+
+	int failures = options.runs - counts[OK];
+	double scale = options.runs > 0 ? 100.0 / options.runs : 0;
+	printf("\nfailures %d (%.1f%%)\n", failures, failures * scale);
+	for (int status = TIMEOUT; status < NUM_STATUSES; status++) {
+		printf("  %-11s %5d (%.1f%%)\n", STATUS_NAMES[status], counts[status], counts[status] * scale);
+	}
+	return 0;
+}
@@ -0,0 +1,342 @@
+// Tunes drive_straight's gains in the simulator: bin/host/PidTuner [options]
+//
+//   --particles N       swarm size (default 16, like okapi::PIDTuner)
+//   --iterations N      swarm updates (default 10)
+//   --plants N          drivetrains each particle is scored on (default 4)
+//   --jobs N            particles scored at a time (default one per CPU)
+//   --seed N            the same seed gives the same plants, swarm and result
+//   --settle-weight W   cost per second of settle time (default 10)
+//
+// okapi::PIDTuner runs a particle swarm by driving the real mechanism, one
+// particle at a time. This runs the same search on sim::DriveTrial instead:
+// every particle drives the moves drive_gain_check() in main.cpp uses on
+// each plant, with the constants both take from DriveConstants.h, and the
+// particles of an iteration are scored on a pool of threads. The
+// controller's readings are a motor report old, as on the robot. Plant 0
+// is robotDrivetrain(). The others stand in for what the feedforward does
+// not know about: each motor's strength and the tire traction are
+// perturbed like MonteCarlo's defaults, the mass by 10% and the battery is
+// anywhere from full to 1.2 V down. The random draws all
+// happen on the main thread and trials do not share state, so the result
+// does not depend on --jobs.
+//
+// The search is over every point of DRIVE_GAINS: kP, kI and kD of the
+// innermost point and kP and kD of the outer two, within bounds that keep
+// the gains plausible for a real robot, whose encoders are noisier than the
+// simulator's. A particle's cost is the mean over moves and plants
+// of ITAE plus --settle-weight times the settle time, both measured on what
+// the gains can change: ITAE of the error from the profile's reference
+// rather than from the target, which the profile keeps far away for most of
+// the move, and the settle time counted from the end of the profile, which
+// stays 0 unless the gains cannot close the last half inch. A tuned gain
+// at the edge of its bounds is pointed out; the simulator has no encoder
+// noise, so it tends to favour more gain than a real robot can take.
+// Particle 0 starts at the current gains, so the result is never worse than
+// them on these plants.
+//
+// To check the result on the robot, put it in DRIVE_GAINS and run
+// drive_gain_check() from autonomous(); it prints the same scores as the
+// table at the end, which is the prediction for the nominal plant.
+#include "DriveConstants.h"
+#include "DriveTrain.h"
+#include "MotionProfile.h"
+#include "sim/DriveTrial.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t PERIOD_MS = 10;
+// readings a motor report old, see DriveTrial
+static constexpr uint32_t LATENCY_MS = 10;
+
+// the schedule points of DRIVE_GAINS, innermost first
+static const GainSchedule::Point& NEAR = DRIVE_GAINS.getPoint(0);
+static const GainSchedule::Point& MID = DRIVE_GAINS.getPoint(1);
+static const GainSchedule::Point& FAR = DRIVE_GAINS.getPoint(2);
+
+// searched gains: kP, kI, kD of the innermost schedule point, then kP and
+// kD of the middle and outer points
+static constexpr int DIMENSIONS = 7;
+using Gains = std::array<double, DIMENSIONS>;
+static const Gains CURRENT = {NEAR.gains.kP, NEAR.gains.kI, NEAR.gains.kD, MID.gains.kP,
+                              MID.gains.kD,  FAR.gains.kP,  FAR.gains.kD};
+static const Gains LOWER = {200, 0, 0, 100, 0, 100, 0};
+static const Gains UPPER = {2400, 1200, 150, 1600, 120, 1200, 100};
+static const GainSchedule::Point* const POINTS[DIMENSIONS] = {&NEAR, &NEAR, &NEAR, &MID, &MID, &FAR, &FAR};
+static const char* const NAMES[DIMENSIONS] = {"kP", "kI", "kD", "kP", "kD", "kP", "kD"};
+
+// constriction coefficients (Clerc and Kennedy)
+static constexpr double INERTIA = 0.7298;
+static constexpr double ATTRACTION = 1.4962;
+// fraction of the search range a particle may move per iteration
+static constexpr double MAX_SPEED = 0.2;
+
+struct Options {
+	int particles = 16;
+	int iterations = 10;
+	int plants = 4;
+	int jobs = 0;
+	uint64_t seed = 1;
+	double settleWeight = 10;
+};
+
+struct Cost {
+	double total = INFINITY;
+	double itae = 0;       // mean per move, of the tracking error
+	double settle = 0;     // mean seconds after the profile ends
+	double worstSettle = 0;
+	int unsettled = 0;
+};
+
+struct Particle {
+	Gains position;
+	Gains velocity;
+	Gains best;
+	Cost cost;
+	Cost bestCost;
+};
+
+static void usage(const char* name) {
+	fprintf(stderr,
+	        "usage: %s [--particles N] [--iterations N] [--plants N] [--jobs N] [--seed N] [--settle-weight W]\n",
+	        name);
+	exit(2);
+}
+
+static GainSchedule schedule(const Gains& gains) {
+	return GainSchedule(GainSchedule::Key::ERROR, {
+	                                                  {NEAR.key, {gains[0], gains[1], gains[2]}},
+	                                                  {MID.key, {gains[3], 0, gains[4]}},
+	                                                  {FAR.key, {gains[5], 0, gains[6]}},
+	                                              });
+}
+
+// a straight move like drive_straight(distance); itae, if given, gets the
+// ITAE of the tracking error
+static sim::DriveTrial::Result drive(const sim::DrivetrainSimulator::Config& plant, const Gains& gains,
+                                     double distance, double* itae = nullptr, double* duration = nullptr) {
+	MotionProfile profile(distance, DriveTrain::MAX_SPEED * GAIN_CHECK_POWER / DriveTrain::MAX_POWER, DRIVE_MAX_ACCEL,
+	                      DRIVE_JERK_TIME);
+	ProfileFollower follower(profile, DRIVE_FEEDFORWARD, schedule(gains), DRIVE_MAX_VOLTAGE, DRIVE_TOLERANCE);
+	sim::DriveTrial trial(plant, PERIOD_MS, LATENCY_MS);
+	if (duration) {
+		*duration = profile.getDuration();
+	}
+	return trial.run(distance, [&](double t, double position, double velocity, double) {
+		if (itae) {
+			*itae += t * std::fabs(profile.sample(t).position - position) * PERIOD_MS / 1000.0;
+		}
+		return follower.update(t, position, velocity);
+	}, GAIN_CHECK_SECONDS, DRIVE_TOLERANCE);
+}
+
+static Cost evaluate(const std::vector<sim::DrivetrainSimulator::Config>& plants, const Gains& gains,
+                     double settleWeight) {
+	Cost cost;
+	cost.total = 0;
+	int trials = 0;
+	for (const sim::DrivetrainSimulator::Config& plant : plants) {
+		for (double distance : GAIN_CHECK_MOVES) {
+			double duration;
+			sim::DriveTrial::Result result = drive(plant, gains, distance, &cost.itae, &duration);
+			double settle = std::max(0.0, result.settleTime - duration);
+			cost.settle += settle;
+			cost.worstSettle = std::max(cost.worstSettle, settle);
+			cost.unsettled += !result.settled;
+			trials++;
+		}
+	}
+	cost.itae /= trials;
+	cost.settle /= trials;
+	cost.total = cost.itae + settleWeight * cost.settle;
+	return cost;
+}
+
+// runs work(0) to work(count - 1) on up to jobs threads
+static void parallel_for(int count, int jobs, const std::function<void(int)>& work) {
+	std::atomic<int> next{0};
+	std::vector<std::thread> threads;
+	for (int i = 0; i < std::min(jobs, count); i++) {
+		threads.emplace_back([&] {
+			for (int index; (index = next++) < count;) {
+				work(index);
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+static std::vector<sim::DrivetrainSimulator::Config> make_plants(int count, std::mt19937_64& rng) {
+	std::normal_distribution<double> strength(1, 0.05);
+	std::normal_distribution<double> traction(1, 0.15);
+	std::normal_distribution<double> mass(1, 0.1);
+	std::uniform_real_distribution<double> sag(0, 1.2);
+	std::vector<sim::DrivetrainSimulator::Config> plants;
+	for (int i = 0; i < count; i++) {
+		sim::DrivetrainSimulator::Config plant = sim::robotDrivetrain();
+		if (i > 0) {
+			for (auto* side : {&plant.left, &plant.right}) {
+				for (sim::DrivetrainSimulator::Mount& mount : *side) {
+					mount.strength = std::max(0.5, strength(rng));
+				}
+			}
+			plant.traction *= std::max(0.5, traction(rng));
+			plant.mass *= std::max(0.5, mass(rng));
+			plant.batteryVoltage -= sag(rng);
+		}
+		plants.push_back(plant);
+	}
+	return plants;
+}
+
+static void print_gains(const Gains& gains) {
+	printf("    {%g, {%.0f, %.0f, %.0f}},\n", NEAR.key, gains[0], gains[1], gains[2]);
+	printf("    {%g, {%.0f, 0, %.0f}},\n", MID.key, gains[3], gains[4]);
+	printf("    {%g, {%.0f, 0, %.0f}},\n", FAR.key, gains[5], gains[6]);
+}
+
+static void print_cost(const char* label, const Cost& cost) {
+	printf("%-8s %8.2f %8.2f %8.2f %8.2f", label, cost.total, cost.itae, cost.settle, cost.worstSettle);
+	if (cost.unsettled) {
+		printf("  %d not settled", cost.unsettled);
+	}
+	printf("\n");
+}
+
+int main(int argc, char** argv) {
+	if (DRIVE_GAINS.getCount() != 3) {
+		fprintf(stderr, "the search is laid out for a DRIVE_GAINS of 3 points, it has %d\n", DRIVE_GAINS.getCount());
+		return 2;
+	}
+	Options options;
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+		}
+		const char* value = argv[++i];
+		if (strcmp(arg, "--particles") == 0) {
+			options.particles = atoi(value);
+		} else if (strcmp(arg, "--iterations") == 0) {
+			options.iterations = atoi(value);
+		} else if (strcmp(arg, "--plants") == 0) {
+			options.plants = atoi(value);
+		} else if (strcmp(arg, "--jobs") == 0) {
+			options.jobs = atoi(value);
+		} else if (strcmp(arg, "--seed") == 0) {
+			options.seed = strtoull(value, nullptr, 10);
+		} else if (strcmp(arg, "--settle-weight") == 0) {
+			options.settleWeight = atof(value);
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (options.particles < 1 || options.iterations < 0 || options.plants < 1) {
+		usage(argv[0]);
+	}
+	if (options.jobs <= 0) {
+		options.jobs = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	auto wallStart = std::chrono::steady_clock::now();
+	std::mt19937_64 plantRng(options.seed);
+	std::mt19937_64 swarmRng(options.seed ^ 0x9e3779b97f4a7c15);
+	std::uniform_real_distribution<double> uniform(0, 1);
+	const std::vector<sim::DrivetrainSimulator::Config> plants = make_plants(options.plants, plantRng);
+
+	std::vector<Particle> swarm(options.particles);
+	for (int i = 0; i < options.particles; i++) {
+		Particle& particle = swarm[i];
+		for (int d = 0; d < DIMENSIONS; d++) {
+			double range = UPPER[d] - LOWER[d];
+			particle.position[d] = LOWER[d] + range * uniform(swarmRng);
+			particle.velocity[d] = range * MAX_SPEED * (2 * uniform(swarmRng) - 1);
+		}
+	}
+	swarm[0].position = CURRENT;
+
+	printf("%-8s %8s %8s %8s %8s\n", "", "cost", "itae", "settle_s", "worst_s");
+	Gains best = CURRENT;
+	Cost bestCost;
+	Cost current;
+	for (int iteration = 0; iteration <= options.iterations; iteration++) {
+		if (iteration > 0) {
+			for (Particle& particle : swarm) {
+				for (int d = 0; d < DIMENSIONS; d++) {
+					double range = UPPER[d] - LOWER[d];
+					double v = INERTIA * particle.velocity[d] +
+					           ATTRACTION * uniform(swarmRng) * (particle.best[d] - particle.position[d]) +
+					           ATTRACTION * uniform(swarmRng) * (best[d] - particle.position[d]);
+					v = std::clamp(v, -range * MAX_SPEED, range * MAX_SPEED);
+					double p = particle.position[d] + v;
+					if (p < LOWER[d] || p > UPPER[d]) {
+						p = std::clamp(p, LOWER[d], UPPER[d]);
+						v = 0;
+					}
+					particle.position[d] = p;
+					particle.velocity[d] = v;
+				}
+			}
+		}
+
+		parallel_for(options.particles, options.jobs, [&](int i) {
+			swarm[i].cost = evaluate(plants, swarm[i].position, options.settleWeight);
+		});
+
+		// particle order, not finishing order, so ties break the same way
+		for (Particle& particle : swarm) {
+			if (iteration == 0 || particle.cost.total < particle.bestCost.total) {
+				particle.best = particle.position;
+				particle.bestCost = particle.cost;
+			}
+			if (particle.bestCost.total < bestCost.total) {
+				best = particle.best;
+				bestCost = particle.bestCost;
+			}
+		}
+		if (iteration == 0) {
+			current = swarm[0].cost;
+			print_cost("current", current);
+		}
+		char label[16];
+		snprintf(label, sizeof(label), "iter %d", iteration);
+		print_cost(label, bestCost);
+	}
+
+	double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+	int trials = (options.iterations + 1) * options.particles * options.plants * (int) std::size(GAIN_CHECK_MOVES);
+	printf("\n%d trials on %d jobs in %.1f s, cost %.2f -> %.2f\n", trials, options.jobs, wallTime, current.total,
+	       bestCost.total);
+	printf("current DRIVE_GAINS:\n");
+	print_gains(CURRENT);
+	printf("tuned:\n");
+	print_gains(best);
+	for (int d = 0; d < DIMENSIONS; d++) {
+		double range = UPPER[d] - LOWER[d];
+		if (best[d] <= LOWER[d] + 0.01 * range || best[d] >= UPPER[d] - 0.01 * range) {
+			printf("  %g in %s is at the edge of its bounds [%g, %g]\n", POINTS[d]->key, NAMES[d], LOWER[d], UPPER[d]);
+		}
+	}
+	printf("\n");
+
+	// what drive_gain_check() should print on the robot with these gains
+	printf("predicted drive_gain_check(), nominal plant:\n");
+	for (double distance : GAIN_CHECK_MOVES) {
+		sim::DriveTrial::Result result = drive(plants[0], best, distance);
+		printf("gain check %+5.0f in: itae %6.1f, settle %5.2f s, overshoot %5.2f in%s\n", distance, result.itae,
+		       result.settleTime, result.overshoot, result.settled ? "" : ", not settled");
+	}
+	return 0;
+}
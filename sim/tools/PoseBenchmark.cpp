@@ -0,0 +1,210 @@
+// Checks PoseEstimator against a known path: bin/host/PoseBenchmark [--seed N] [--time S]
+//
+// A robot drives loops around the field while the tool generates what its
+// sensors would read: six drive encoders with quantization, slip and a 1%
+// wheel size error, an IMU with drift, and two distance sensors that now and
+// then see another robot instead of the wall. The same readings go to dead
+// reckoning (encoders plus IMU heading, what the autonomous does now) and to
+// the estimator with and without the distance sensors. Prints position and
+// heading errors and the time per 10 ms tick. Exits non-zero if the fused
+// estimate with distance sensors is not better than dead reckoning.
+#include "DriveConstants.h"
+#include "DriveTrain.h"
+#include "PoseEstimator.h"
+#include "RobotSpecifics.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static constexpr double PI = 3.14159265358979;
+static constexpr double FIELD = 144;       // inches
+static constexpr double SENSOR_RANGE = 78; // V5 distance sensor, inches
+static constexpr double TICK = 0.01;       // control period, seconds
+static constexpr int SUBSTEPS = 10;
+
+static const PoseEstimator::DistanceSensor SENSORS[] = {
+    {-6, 0, PI, 0.5},    // back
+    {0, 6, PI / 2, 0.5}, // left side
+};
+
+static const PoseEstimator::Wall WALLS[] = {{1, 0, 0}, {1, 0, FIELD}, {0, 1, 0}, {0, 1, FIELD}};
+
+struct Error {
+	const char* name;
+	double squared = 0;
+	double worst = 0;
+	double heading = 0;
+	int samples = 0;
+
+	void add(const PoseEstimator::Pose& truth, const PoseEstimator::Pose& estimate) {
+		double distance = std::hypot(truth.x - estimate.x, truth.y - estimate.y);
+		squared += distance * distance;
+		worst = std::max(worst, distance);
+		heading = std::max(heading, std::fabs(std::remainder(truth.heading - estimate.heading, 2 * PI)));
+		samples++;
+	}
+
+	void print(const PoseEstimator::Pose& truth, const PoseEstimator::Pose& estimate) const {
+		printf("%-28s %8.2f %8.2f %8.2f %8.2f\n", name, std::sqrt(squared / samples), worst,
+		       std::hypot(truth.x - estimate.x, truth.y - estimate.y), heading * 180 / PI);
+	}
+};
+
+// beam length from a pose to one wall, or a negative number if it points away
+static double beam_length(const PoseEstimator::Pose& pose, const PoseEstimator::DistanceSensor& sensor,
+                          const PoseEstimator::Wall& wall) {
+	double c = std::cos(pose.heading), s = std::sin(pose.heading);
+	double x = pose.x + sensor.x * c - sensor.y * s;
+	double y = pose.y + sensor.x * s + sensor.y * c;
+	double incidence = wall.normalX * std::cos(pose.heading + sensor.angle) +
+	                   wall.normalY * std::sin(pose.heading + sensor.angle);
+	if (std::fabs(incidence) < 1e-9) {
+		return -1;
+	}
+	return (wall.offset - wall.normalX * x - wall.normalY * y) / incidence;
+}
+
+// the wall a sensor faces from a pose: the nearest one ahead of it
+static const PoseEstimator::Wall* facing_wall(const PoseEstimator::Pose& pose,
+                                              const PoseEstimator::DistanceSensor& sensor, double* length) {
+	const PoseEstimator::Wall* facing = nullptr;
+	for (const PoseEstimator::Wall& wall : WALLS) {
+		double d = beam_length(pose, sensor, wall);
+		if (d > 0 && (!facing || d < *length)) {
+			facing = &wall;
+			*length = d;
+		}
+	}
+	return facing;
+}
+
+int main(int argc, char** argv) {
+	unsigned seed = 1;
+	double duration = 60;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+			duration = strtod(argv[++i], nullptr);
+		} else {
+			fprintf(stderr, "usage: %s [--seed N] [--time S]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	std::mt19937_64 rng(seed);
+	std::normal_distribution<double> normal(0, 1);
+	std::uniform_real_distribution<double> uniform(0, 1);
+
+	PoseEstimator::Pose truth = {72, 24, 0};
+	PoseEstimator fused(DRIVE_TRACK_WIDTH, POSE_NOISE);
+	PoseEstimator ranged(DRIVE_TRACK_WIDTH, POSE_NOISE);
+	fused.reset(truth);
+	ranged.reset(truth);
+	PoseEstimator::Pose reckoned = truth;
+
+	// true distance each side's wheels have turned, and slip per side
+	double wheel[2] = {0, 0};
+	double slip[2] = {0, 0};
+	double lastAverage = 0;
+	double imuDrift = 0;
+	Error reckonedError{"dead reckoning"};
+	Error fusedError{"encoders + IMU"};
+	Error rangedError{"encoders + IMU + distance"};
+	int accepted = 0, rejected = 0;
+	std::chrono::nanoseconds elapsed(0);
+	int ticks = 0;
+
+	for (double t = 0; t < duration; t += TICK) {
+		// loops around the field at 20 to 40 in/s, radius around 45 inches
+		for (int i = 0; i < SUBSTEPS; i++) {
+			double now = t + i * TICK / SUBSTEPS;
+			double dt = TICK / SUBSTEPS;
+			double v = 30 + 10 * std::sin(1.3 * now);
+			double w = v / 45 + 0.4 * std::sin(2.1 * now);
+			double middle = truth.heading + w * dt / 2;
+			truth.x += v * dt * std::cos(middle);
+			truth.y += v * dt * std::sin(middle);
+			truth.heading += w * dt;
+			for (int side = 0; side < 2; side++) {
+				slip[side] = 0.99 * slip[side] + 0.5 * normal(rng);
+				double speed = v + (side == 0 ? -0.5 : 0.5) * DRIVE_TRACK_WIDTH * w + slip[side];
+				wheel[side] += speed * dt * 1.01;
+			}
+		}
+		truth.heading = std::remainder(truth.heading, 2 * PI);
+
+		std::array<double, PoseEstimator::DRIVE_ENCODERS> distances;
+		for (int i = 0; i < PoseEstimator::DRIVE_ENCODERS; i++) {
+			const double ticks = std::round(wheel[i / 3] * DriveTrain::TICKS_PER_INCH + 0.3 * normal(rng));
+			distances[i] = ticks / DriveTrain::TICKS_PER_INCH;
+		}
+		imuDrift += 1.0 / 60 * TICK; // degrees per minute
+		double rotation = -truth.heading * 180 / PI + imuDrift + 0.05 * normal(rng);
+		double rate = -(30 + 10 * std::sin(1.3 * t)) / 45 * 180 / PI - 0.4 * std::sin(2.1 * t) * 180 / PI +
+		              0.3 * normal(rng);
+
+		double left = (distances[0] + distances[1] + distances[2]) / 3;
+		double right = (distances[3] + distances[4] + distances[5]) / 3;
+		double average = (left + right) / 2;
+		double heading = -rotation * PI / 180;
+		reckoned.x += (average - lastAverage) * std::cos(heading);
+		reckoned.y += (average - lastAverage) * std::sin(heading);
+		reckoned.heading = std::remainder(heading, 2 * PI);
+		lastAverage = average;
+
+		std::array<double, 2> ranges;
+		for (int i = 0; i < 2; i++) {
+			double length = 0;
+			ranges[i] = facing_wall(truth, SENSORS[i], &length) && length < SENSOR_RANGE ? length : -1;
+			if (ranges[i] > 0) {
+				ranges[i] += SENSORS[i].noise * normal(rng);
+				if (uniform(rng) < 0.02) {
+					ranges[i] *= uniform(rng); // another robot in the way
+				}
+			}
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		for (PoseEstimator* estimator : {&fused, &ranged}) {
+			estimator->predict(TICK);
+			estimator->updateDrive(distances, TICK);
+			estimator->updateImu(rotation, rate);
+		}
+		for (int i = 0; i < 2; i++) {
+			double length = 0;
+			const PoseEstimator::Wall* wall = facing_wall(ranged.getPose(), SENSORS[i], &length);
+			if (ranges[i] > 0 && wall) {
+				(ranged.updateDistance(SENSORS[i], *wall, ranges[i]) ? accepted : rejected)++;
+			}
+		}
+		elapsed += std::chrono::steady_clock::now() - start;
+		ticks++;
+
+		reckonedError.add(truth, reckoned);
+		fusedError.add(truth, fused.getPose());
+		rangedError.add(truth, ranged.getPose());
+	}
+
+	printf("%.0f s, seed %u, position error in inches, heading in degrees\n", duration, seed);
+	printf("%-28s %8s %8s %8s %8s\n", "estimate", "rms", "max", "final", "heading");
+	reckonedError.print(truth, reckoned);
+	fusedError.print(truth, fused.getPose());
+	rangedError.print(truth, ranged.getPose());
+	printf("distance readings: %d used, %d rejected\n", accepted, rejected);
+	printf("host time per tick for both estimators: %.2f us\n",
+	       std::chrono::duration<double, std::micro>(elapsed).count() / ticks);
+
+	bool better = rangedError.squared < reckonedError.squared;
+	if (!better) {
+		printf("FAIL: the fused estimate is worse than dead reckoning\n");
+	}
+	return better ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+// Compares okapi's settle detectors on simulated error traces:
+// bin/host/SettleBenchmark [--runs N] [--seed N]
+//
+// Each trace is an error decaying towards 0 in one of a few ways, sampled
+// every 10 ms with sensor noise. SettledUtil (every sample in the band with
+// a small change for the dwell time) and WindowedSettledUtil (RMS, peak to
+// peak and trend over the window, or early on the decay envelope) see the
+// same samples with the same limits. A detection is false if the error
+// leaves the band after it. Prints the mean time each takes to say
+// settled, how often the window settled early, and false detections; exits
+// non-zero if the windowed one has more false detections or is slower.
+#include "okapi/api/control/util/settledUtil.hpp"
+#include "okapi/api/control/util/windowedSettledUtil.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+
+using namespace okapi;
+
+static constexpr double PERIOD = 0.01;   // seconds
+static constexpr double DURATION = 4;    // seconds per trace
+static constexpr double BAND = 2;        // error units
+static constexpr double DERIVATIVE = 0.5; // per sample
+static const QTime DWELL = 250_ms;
+static constexpr double NOISE = 0.2;     // standard deviation of the sensor noise
+
+// a timer the benchmark moves by hand
+class SteppedTimer : public AbstractTimer {
+  public:
+  explicit SteppedTimer(const QTime *inow) : AbstractTimer(*inow), now(inow) {
+  }
+
+  QTime millis() const override {
+    return *now;
+  }
+
+  private:
+  const QTime *now;
+};
+
+struct Trace {
+	const char* name;
+	std::function<double(double t)> error;
+};
+
+struct Tally {
+	double detectTime = 0;
+	int detected = 0;
+	int early = 0;
+	int falseDetections = 0;
+};
+
+int main(int argc, char** argv) {
+	int runs = 50;
+	unsigned seed = 1;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+			runs = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		} else {
+			fprintf(stderr, "usage: %s [--runs N] [--seed N]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	const Trace traces[] = {
+	    {"overdamped", [](double t) { return 100 * std::exp(-t / 0.15); }},
+	    {"slow approach", [](double t) { return 100 * std::exp(-t / 0.6); }},
+	    {"underdamped", [](double t) { return 100 * std::exp(-t / 0.3) * std::cos(2 * M_PI * 2 * t); }},
+	    {"barely damped", [](double t) { return 60 * std::exp(-t / 0.8) * std::cos(2 * M_PI * 1.5 * t); }},
+	    {"stops short", [](double t) { return 1.5 + 100 * std::exp(-t / 0.2); }},
+	};
+
+	std::mt19937_64 rng(seed);
+	std::normal_distribution<double> noise(0, NOISE);
+	printf("%d runs per trace, band %.1f, dwell %.0f ms, noise %.1f\n", runs, BAND, DWELL.convert(millisecond), NOISE);
+	printf("%-20s %-10s %9s %9s %7s %7s\n", "trace", "detector", "settled", "mean_ms", "early", "false");
+
+	bool ok = true;
+	for (const Trace& trace : traces) {
+		Tally tallies[2];
+		for (int run = 0; run < runs; run++) {
+			QTime now = 1_s;
+			std::unique_ptr<SettledUtil> detectors[2] = {
+			    std::make_unique<SettledUtil>(std::make_unique<SteppedTimer>(&now), BAND, DERIVATIVE, DWELL),
+			    std::make_unique<WindowedSettledUtil>(std::make_unique<SteppedTimer>(&now), BAND, DERIVATIVE, DWELL)};
+			double detectedAt[2] = {-1, -1};
+			bool early[2] = {false, false};
+			double lastOut = 0; // last time the true error was out of the band
+			for (double t = 0; t < DURATION; t += PERIOD) {
+				now = 1_s + t * second;
+				double error = trace.error(t);
+				if (std::fabs(error) > BAND) {
+					lastOut = t;
+				}
+				double measured = error + noise(rng);
+				for (int d = 0; d < 2; d++) {
+					if (detectors[d]->isSettled(measured) && detectedAt[d] < 0) {
+						detectedAt[d] = t;
+						early[d] = d == 1 && static_cast<WindowedSettledUtil&>(*detectors[d]).getWindow().isPredicted();
+					}
+				}
+			}
+			for (int d = 0; d < 2; d++) {
+				if (detectedAt[d] < 0) {
+					continue;
+				}
+				tallies[d].detected++;
+				tallies[d].detectTime += detectedAt[d];
+				tallies[d].early += early[d];
+				tallies[d].falseDetections += detectedAt[d] < lastOut;
+			}
+		}
+
+		const char* names[2] = {"SettledUtil", "windowed"};
+		for (int d = 0; d < 2; d++) {
+			const Tally& tally = tallies[d];
+			printf("%-20s %-10s %5d/%-3d %9.0f %7d %7d\n", d == 0 ? trace.name : "", names[d], tally.detected, runs,
+			       tally.detected ? 1000 * tally.detectTime / tally.detected : 0.0, tally.early, tally.falseDetections);
+		}
+		const Tally& plain = tallies[0];
+		const Tally& windowed = tallies[1];
+		if (windowed.falseDetections > plain.falseDetections ||
+		    (windowed.detected && plain.detected &&
+		     windowed.detectTime / windowed.detected > plain.detectTime / plain.detected + PERIOD)) {
+			ok = false;
+		}
+	}
+
+	if (!ok) {
+		printf("FAIL: the windowed detector is slower or has more false detections\n");
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Compares straight move controllers on the simulated drivetrain:
+// bin/host/TrackingBenchmark
+//
+// Each controller drives the same moves on sim::DriveTrial: PID on the
+// final target, ProfileFollower with the fixed PD gains drive_straight used
+// before, and with the gain schedule it uses now (keyed on the error, with
+// an integral near the target). Prints how closely each tracks the profile,
+// overshoot and the time until it stays within half an inch.
+#include "DriveConstants.h"
+#include "DriveTrain.h"
+#include "MotionProfile.h"
+#include "sim/DriveTrial.h"
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+static constexpr double DURATION = 4;     // seconds per move
+// the fixed PD gains drive_straight used before DRIVE_GAINS
+static const ProfileFollower::Gains OLD_GAINS = {400, 40};
+
+struct Tracked {
+	const char* name;
+	std::function<sim::DriveTrial::Controller(const MotionProfile& profile, double* squared, int* samples)> make;
+};
+
+static Tracked follower(const char* name, const GainSchedule& schedule) {
+	return {name, [=](const MotionProfile& profile, double* squared, int* samples) {
+		        auto follower = std::make_shared<ProfileFollower>(profile, DRIVE_FEEDFORWARD, schedule, DRIVE_MAX_VOLTAGE,
+		                                                           DRIVE_TOLERANCE);
+		        return [=](double t, double position, double velocity, double) {
+			        double voltage = follower->update(t, position, velocity);
+			        *squared += std::pow(follower->getReference().position - position, 2);
+			        ++*samples;
+			        return voltage;
+		        };
+	        }};
+}
+
+int main() {
+	sim::DriveTrial trial(sim::robotDrivetrain());
+	const double distances[] = {6, 24, 48, -24};
+
+	const Tracked controllers[] = {
+	    {"PID on the target",
+	     [](const MotionProfile& profile, double* squared, int* samples) {
+		     auto controller = std::make_shared<TrackingController>(Feedforward{0, 0, 0},
+		                                                            GainSchedule({400, 0, 40}), 12000);
+		     return [=](double t, double position, double velocity, double battery) {
+			     ProfileState reference = profile.sample(t);
+			     *squared += std::pow(reference.position - position, 2);
+			     ++*samples;
+			     ProfileState target;
+			     target.position = profile.getDistance();
+			     return controller->update(0.01, target, position, velocity, battery);
+		     };
+	     }},
+	    follower("follower, fixed PD", GainSchedule({OLD_GAINS.kP, 0, OLD_GAINS.kD})),
+	    follower("follower, scheduled PID", DRIVE_GAINS),
+	};
+
+	printf("%-26s %7s %9s %9s %9s %9s %7s\n", "controller", "move", "track_rms", "overshoot", "settle_s", "itae",
+	       "final");
+	for (double distance : distances) {
+		MotionProfile profile(distance, DriveTrain::MAX_SPEED * 100 / DriveTrain::MAX_POWER, DRIVE_MAX_ACCEL,
+		                      DRIVE_JERK_TIME);
+		for (const Tracked& tracked : controllers) {
+			double squared = 0;
+			int samples = 0;
+			sim::DriveTrial::Result result =
+			    trial.run(distance, tracked.make(profile, &squared, &samples), DURATION, DRIVE_TOLERANCE);
+			printf("%-26s %7.1f %9.2f %9.2f %9.2f %9.1f %7.2f%s\n", tracked.name, distance,
+			       std::sqrt(squared / samples), result.overshoot, result.settleTime, result.itae, result.finalError,
+			       result.settled ? "" : " not settled");
+		}
+		printf("  profile duration %.2f s\n", profile.getDuration());
+	}
+	return 0;
+}
@@ -0,0 +1,165 @@
+// Compares velocity estimates from motor readings: bin/host/VelocityBenchmark [--seed N]
+//
+// A flywheel motor spins up, takes a shot every two seconds and spins down.
+// The motor reports its raw position every 10 ms with the brain's timestamp;
+// a control loop with scheduler jitter wakes every 10 ms and reads the newest
+// report, the way Flywheel's task does. Each estimator sees the same
+// readings and is scored against the true speed at the moment the loop
+// woke, so lag counts as error. Exits non-zero if the timestamped estimators
+// are not better than the position change over the loop timer.
+#include "VelocityEstimator.h"
+#include "okapi/api/filter/emaFilter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+static constexpr double COUNTS_PER_REV = 900; // green cartridge
+static constexpr double DURATION = 10;        // seconds
+static constexpr int REPORT_MS = 10;
+static constexpr int LOOP_MS = 10;
+
+// rpm: spin up to 175, a 40 rpm dip every two seconds from a shot, spin down
+static double true_speed(double t) {
+	if (t < 0.5) {
+		return 350 * t;
+	}
+	if (t > DURATION - 1) {
+		return std::max(0.0, 175 * (DURATION - 0.5 - t) / 0.5);
+	}
+	double since = std::fmod(t - 0.5, 2.0);
+	if (t > 1.5 && since < 0.03) {
+		return 175 - 40 * since / 0.03;
+	}
+	if (t > 1.5 && since < 0.33) {
+		return 135 + 40 * (since - 0.03) / 0.3;
+	}
+	return 175;
+}
+
+// position in counts, integrated at 0.1 ms
+struct Motor {
+	double t = 0;
+	double counts = 0;
+
+	double advance(double to) {
+		for (; t + 1e-4 <= to; t += 1e-4) {
+			counts += true_speed(t + 5e-5) / 60 * COUNTS_PER_REV * 1e-4;
+		}
+		return counts;
+	}
+};
+
+struct Reading {
+	int32_t counts;
+	uint32_t timestamp;
+	double wake; // seconds, when the loop read it
+};
+
+struct Score {
+	const char* name;
+	double squared = 0;
+	double steadySquared = 0;
+	double worst = 0;
+	int samples = 0;
+	int steadySamples = 0;
+};
+
+static bool steady(double t) {
+	double since = std::fmod(t - 0.5, 2.0);
+	return t > 0.6 && t < DURATION - 1 && (t < 1.5 || since > 0.45);
+}
+
+static Score score(const char* name, const std::vector<Reading>& readings, std::function<double(const Reading&)> estimate) {
+	Score s{name};
+	for (const Reading& reading : readings) {
+		double error = estimate(reading) - true_speed(reading.wake);
+		s.squared += error * error;
+		s.worst = std::max(s.worst, std::fabs(error));
+		s.samples++;
+		if (steady(reading.wake)) {
+			s.steadySquared += error * error;
+			s.steadySamples++;
+		}
+	}
+	printf("%-32s %8.2f %8.2f %8.2f\n", name, std::sqrt(s.squared / s.samples),
+	       std::sqrt(s.steadySquared / s.steadySamples), s.worst);
+	return s;
+}
+
+int main(int argc, char** argv) {
+	unsigned seed = 1;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		} else {
+			fprintf(stderr, "usage: %s [--seed N]\n", argv[0]);
+			return 2;
+		}
+	}
+	std::mt19937_64 rng(seed);
+	std::normal_distribution<double> jitter(0, 1.5);
+	std::uniform_real_distribution<double> uniform(0, 1);
+
+	// the loop wakes LOOP_MS apart on average, 3 ms out of phase with the
+	// motor, with jitter and the odd late tick
+	Motor motor;
+	Reading latest{0, 0, 0};
+	std::vector<Reading> readings;
+	double nextReport = REPORT_MS / 1000.0;
+	for (int tick = 1; tick * LOOP_MS < DURATION * 1000; tick++) {
+		double wake = (tick * LOOP_MS + 3 + std::clamp(jitter(rng), -3.0, 3.0)) / 1000.0;
+		if (uniform(rng) < 0.01) {
+			wake += 0.005;
+		}
+		while (nextReport <= wake) {
+			// the motor samples up to a millisecond before the brain stamps the reading
+			double sampled = nextReport - 0.001 * uniform(rng);
+			latest.counts = (int32_t) std::floor(motor.advance(sampled));
+			latest.timestamp = (uint32_t) std::lround(nextReport * 1000);
+			nextReport += REPORT_MS / 1000.0;
+		}
+		latest.wake = wake;
+		readings.push_back(latest);
+	}
+
+	printf("rpm error, %zu loop ticks, seed %u\n", readings.size(), seed);
+	printf("%-32s %8s %8s %8s\n", "estimator", "rms", "steady", "max");
+
+	// okapi::VelMath's approach: position change over the loop timer
+	auto loop_delta = [](okapi::EmaFilter* filter) {
+		return [filter, last = Reading{0, 0, 0}](const Reading& reading) mutable {
+			double dt = reading.wake - last.wake;
+			double rpm = dt > 0 ? (reading.counts - last.counts) / COUNTS_PER_REV * 60 / dt : 0;
+			last = reading;
+			return filter ? filter->filter(rpm) : rpm;
+		};
+	};
+	okapi::EmaFilter ema(0.3);
+	Score naive = score("delta / loop dt", readings, loop_delta(nullptr));
+	Score smoothed = score("delta / loop dt, EMA 0.3", readings, loop_delta(&ema));
+
+	auto timestamped = [](int window, VelocityEstimator::Method method) {
+		return [estimator = VelocityEstimator(COUNTS_PER_REV, window, method)](const Reading& reading) mutable {
+			estimator.addSample(reading.counts, reading.timestamp);
+			return estimator.getVelocity();
+		};
+	};
+	using Method = VelocityEstimator::Method;
+	score("timestamps, slope over 3", readings, timestamped(3, Method::SLOPE));
+	Score slope = score("timestamps, slope over 5", readings, timestamped(5, Method::SLOPE));
+	score("timestamps, Savitzky-Golay 5", readings, timestamped(5, Method::SAVITZKY_GOLAY));
+	Score golay = score("timestamps, Savitzky-Golay 7", readings, timestamped(7, Method::SAVITZKY_GOLAY));
+
+	bool better = slope.squared < smoothed.squared && golay.squared < smoothed.squared &&
+	              slope.steadySquared < naive.steadySquared;
+	if (!better) {
+		printf("FAIL: timestamped estimates are not better than the loop timer\n");
+	}
+	return better ? 0 : 1;
+}
@@ -0,0 +1,339 @@
+#include "Command.h"
+
+#include <mutex>
+
+InstantCommand::InstantCommand(std::function<void()> function, uint32_t requirements) : function(std::move(function)) {
+	this->requirements = requirements;
+}
+
+void InstantCommand::initialize() {
+	function();
+}
+
+WaitCommand::WaitCommand(uint32_t millis) : duration(millis / 1000.0) {}
+
+void WaitCommand::initialize() {
+	elapsed = 0;
+}
+
+void WaitCommand::execute(double dt) {
+	elapsed += dt;
+}
+
+bool WaitCommand::isFinished() {
+	return elapsed >= duration;
+}
+
+WaitUntilCommand::WaitUntilCommand(std::function<bool()> condition) : condition(std::move(condition)) {}
+
+bool WaitUntilCommand::isFinished() {
+	return condition();
+}
+
+StepCommand::StepCommand(std::function<ControlScheduler::Callback()> factory, uint32_t requirements,
+                         std::function<void()> onInterrupt)
+    : factory(std::move(factory)), onInterrupt(std::move(onInterrupt)) {
+	this->requirements = requirements;
+}
+
+void StepCommand::initialize() {
+	step = factory();
+	finished = false;
+}
+
+void StepCommand::execute(double dt) {
+	if (!finished) {
+		finished = step(dt);
+	}
+}
+
+bool StepCommand::isFinished() {
+	return finished;
+}
+
+void StepCommand::end(bool interrupted) {
+	step = nullptr;
+	if (interrupted && onInterrupt) {
+		onInterrupt();
+	}
+}
+
+CommandGroup::CommandGroup(std::vector<CommandPtr> commands) : commands(std::move(commands)) {
+	for (const CommandPtr& command : this->commands) {
+		requirements |= command->getRequirements();
+	}
+}
+
+void SequentialGroup::initialize() {
+	index = 0;
+	stepStart = pros::millis();
+	stepTimes.clear();
+	stepTimes.reserve(commands.size());
+	if (!commands.empty()) {
+		commands[0]->initialize();
+	}
+}
+
+void SequentialGroup::execute(double dt) {
+	// instant commands finish right away, so several may complete in one tick
+	while (index < commands.size()) {
+		commands[index]->execute(dt);
+		if (!commands[index]->isFinished()) {
+			return;
+		}
+		commands[index]->end(false);
+		uint32_t now = pros::millis();
+		stepTimes.push_back(now - stepStart);
+		stepStart = now;
+		if (++index < commands.size()) {
+			commands[index]->initialize();
+		}
+		dt = 0;
+	}
+}
+
+bool SequentialGroup::isFinished() {
+	return index >= commands.size();
+}
+
+void SequentialGroup::end(bool interrupted) {
+	if (interrupted && index < commands.size()) {
+		commands[index]->end(true);
+	}
+}
+
+ParallelGroup::ParallelGroup(std::vector<CommandPtr> commands) : CommandGroup(std::move(commands)) {
+	requirements = 0;
+	for (size_t i = 0; i < this->commands.size();) {
+		uint32_t needs = this->commands[i]->getRequirements();
+		if (requirements & needs) {
+			printf("parallel group: child %d shares a subsystem with an earlier child, left out\n", (int) i);
+			this->commands.erase(this->commands.begin() + i);
+		} else {
+			requirements |= needs;
+			i++;
+		}
+	}
+}
+
+void ParallelGroup::initialize() {
+	running.assign(commands.size(), true);
+	for (const CommandPtr& command : commands) {
+		command->initialize();
+	}
+}
+
+void ParallelGroup::execute(double dt) {
+	for (size_t i = 0; i < commands.size(); i++) {
+		if (!running[i]) {
+			continue;
+		}
+		commands[i]->execute(dt);
+		if (commands[i]->isFinished()) {
+			commands[i]->end(false);
+			running[i] = false;
+		}
+	}
+}
+
+bool ParallelGroup::isFinished() {
+	for (bool isRunning : running) {
+		if (isRunning) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void ParallelGroup::end(bool interrupted) {
+	// anything still running when the group ends was cut short
+	for (size_t i = 0; i < commands.size(); i++) {
+		if (running[i]) {
+			commands[i]->end(true);
+			running[i] = false;
+		}
+	}
+}
+
+bool RaceGroup::isFinished() {
+	for (bool isRunning : running) {
+		if (!isRunning) {
+			return true;
+		}
+	}
+	return running.empty();
+}
+
+bool DeadlineGroup::isFinished() {
+	return running.empty() || !running[0];
+}
+
+bool CommandScheduler::schedule(CommandPtr command) {
+	std::lock_guard<pros::Mutex> lock(mutex);
+	for (CommandPtr& slot : pending) {
+		if (!slot) {
+			slot = std::move(command);
+			return true;
+		}
+	}
+	printf("command scheduler: %d commands already waiting, command dropped\n", MAX_COMMANDS);
+	return false;
+}
+
+// a pending command has not started, so it is dropped right away; an active
+// one is ended by run(), on the task that runs the other commands
+void CommandScheduler::cancel(const CommandPtr& command) {
+	std::lock_guard<pros::Mutex> lock(mutex);
+	for (CommandPtr& slot : pending) {
+		if (slot == command) {
+			slot = nullptr;
+		}
+	}
+	for (const CommandPtr& slot : active) {
+		if (slot && slot == command) {
+			// canceled only holds distinct active commands, so there is room
+			CommandPtr* freeSlot = nullptr;
+			for (CommandPtr& cancelSlot : canceled) {
+				if (cancelSlot == command) {
+					return;
+				}
+				if (!cancelSlot && !freeSlot) {
+					freeSlot = &cancelSlot;
+				}
+			}
+			*freeSlot = command;
+		}
+	}
+}
+
+void CommandScheduler::cancelAll() {
+	std::lock_guard<pros::Mutex> lock(mutex);
+	for (CommandPtr& slot : pending) {
+		slot = nullptr;
+	}
+	cancelingAll = true;
+}
+
+bool CommandScheduler::isScheduled(const CommandPtr& command) {
+	std::lock_guard<pros::Mutex> lock(mutex);
+	for (int i = 0; i < MAX_COMMANDS; i++) {
+		if (active[i] == command || pending[i] == command) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CommandScheduler::run(double dt) {
+	// commands run without the lock, so they may schedule, cancel or check
+	// commands on this scheduler; under it only the slots are updated
+	CommandPtr interrupted[2 * MAX_COMMANDS];
+	int interruptedCount = 0;
+	bool starting[MAX_COMMANDS] = {};
+	CommandPtr ticking[MAX_COMMANDS];
+	{
+		std::lock_guard<pros::Mutex> lock(mutex);
+
+		// end what was canceled since the last tick
+		for (CommandPtr& slot : active) {
+			if (!slot) {
+				continue;
+			}
+			bool cancelSlot = cancelingAll;
+			for (const CommandPtr& command : canceled) {
+				cancelSlot = cancelSlot || command == slot;
+			}
+			if (cancelSlot) {
+				interrupted[interruptedCount++] = std::move(slot);
+				slot = nullptr;
+			}
+		}
+		for (CommandPtr& command : canceled) {
+			command = nullptr;
+		}
+		cancelingAll = false;
+
+		// start pending commands, interrupting whoever owns their subsystems
+		for (CommandPtr& command : pending) {
+			if (!command) {
+				continue;
+			}
+			int freeSlot = -1;
+			for (int i = 0; i < MAX_COMMANDS; i++) {
+				CommandPtr& slot = active[i];
+				if (slot && (slot->getRequirements() & command->getRequirements())) {
+					// a command started this tick has not been initialized, so
+					// it is dropped rather than ended
+					if (!starting[i]) {
+						interrupted[interruptedCount++] = std::move(slot);
+					}
+					slot = nullptr;
+					starting[i] = false;
+				}
+				if (!slot && freeSlot < 0) {
+					freeSlot = i;
+				}
+			}
+			// with every slot taken it waits for one to free up
+			if (freeSlot >= 0) {
+				active[freeSlot] = std::move(command);
+				starting[freeSlot] = true;
+				command = nullptr;
+			}
+		}
+
+		for (int i = 0; i < MAX_COMMANDS; i++) {
+			ticking[i] = active[i];
+		}
+	}
+
+	for (int i = 0; i < interruptedCount; i++) {
+		interrupted[i]->end(true);
+	}
+	bool finished[MAX_COMMANDS] = {};
+	for (int i = 0; i < MAX_COMMANDS; i++) {
+		if (ticking[i] && starting[i]) {
+			ticking[i]->initialize();
+		}
+	}
+	for (int i = 0; i < MAX_COMMANDS; i++) {
+		if (!ticking[i]) {
+			continue;
+		}
+		ticking[i]->execute(dt);
+		if (ticking[i]->isFinished()) {
+			ticking[i]->end(false);
+			finished[i] = true;
+		}
+	}
+
+	std::lock_guard<pros::Mutex> lock(mutex);
+	bool busy = false;
+	for (int i = 0; i < MAX_COMMANDS; i++) {
+		if (finished[i] && active[i] == ticking[i]) {
+			active[i] = nullptr;
+			// it ended on its own, so a cancel queued during the tick is moot
+			for (CommandPtr& command : canceled) {
+				if (command == ticking[i]) {
+					command = nullptr;
+				}
+			}
+		}
+		busy = busy || active[i] || pending[i];
+	}
+	return busy;
+}
+
+bool CommandScheduler::runUntilFinished(ControlScheduler& controlScheduler, CommandPtr command) {
+	if (!schedule(command)) {
+		return false;
+	}
+	bool ran = controlScheduler.run([this, command](double dt) {
+		run(dt);
+		return !isScheduled(command);
+	});
+	if (!ran) {
+		cancel(command);
+	}
+	return ran;
+}
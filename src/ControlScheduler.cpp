@@ -0,0 +1,131 @@
+#include "ControlScheduler.h"
+#include "Latency.h"
+
+#include <mutex>
+
+static LatencySection control_latency("control_tick");
+
+ControlScheduler::ControlScheduler(uint32_t periodMs) : periodMs(periodMs) {}
+
+void ControlScheduler::start(uint32_t priority) {
+	if (task == nullptr) {
+		task = new pros::Task([this] { loop(); }, priority, TASK_STACK_DEPTH_DEFAULT, "control");
+	}
+}
+
+int ControlScheduler::add(Callback callback) {
+	std::lock_guard<pros::Mutex> lock(mutex);
+	for (int i = 0; i < MAX_CALLBACKS; i++) {
+		if (!taken[i]) {
+			taken[i] = true;
+			callbacks[i] = std::move(callback);
+			return i;
+		}
+	}
+	return -1;
+}
+
+void ControlScheduler::remove(int handle) {
+	if (handle < 0 || handle >= MAX_CALLBACKS) {
+		return;
+	}
+	std::lock_guard<pros::Mutex> lock(mutex);
+	taken[handle] = false;
+	callbacks[handle] = nullptr;
+}
+
+bool ControlScheduler::isActive(int handle) {
+	if (handle < 0 || handle >= MAX_CALLBACKS) {
+		return false;
+	}
+	std::lock_guard<pros::Mutex> lock(mutex);
+	return taken[handle];
+}
+
+void ControlScheduler::clear() {
+	std::lock_guard<pros::Mutex> lock(mutex);
+	for (int i = 0; i < MAX_CALLBACKS; i++) {
+		taken[i] = false;
+		callbacks[i] = nullptr;
+	}
+}
+
+bool ControlScheduler::run(Callback callback) {
+	int handle = add(std::move(callback));
+	if (handle < 0) {
+		printf("control scheduler: all %d slots taken, callback not run\n", MAX_CALLBACKS);
+		return false;
+	}
+	while (isActive(handle)) {
+		pros::delay(periodMs);
+	}
+	return true;
+}
+
+ControlScheduler::Stats ControlScheduler::getStats() {
+	std::lock_guard<pros::Mutex> lock(mutex);
+	return stats;
+}
+
+void ControlScheduler::resetStats() {
+	std::lock_guard<pros::Mutex> lock(mutex);
+	stats = Stats();
+}
+
+void ControlScheduler::loop() {
+	const double dt = getDt();
+	uint32_t wakeTime = pros::millis();
+
+	while (true) {
+		pros::Task::delay_until(&wakeTime, periodMs);
+
+		// wakeTime now holds the deadline this tick was scheduled for
+		uint64_t start = pros::micros();
+		uint64_t deadline = (uint64_t) wakeTime * 1000;
+		uint32_t jitter = start > deadline ? (uint32_t) (start - deadline) : 0;
+
+		{
+			std::lock_guard<pros::Mutex> lock(mutex);
+			for (int i = 0; i < MAX_CALLBACKS; i++) {
+				running[i] = std::move(callbacks[i]);
+				callbacks[i] = nullptr;
+			}
+		}
+		bool finished[MAX_CALLBACKS] = {};
+		for (int i = 0; i < MAX_CALLBACKS; i++) {
+			finished[i] = running[i] && running[i](dt);
+		}
+
+		std::lock_guard<pros::Mutex> lock(mutex);
+		for (int i = 0; i < MAX_CALLBACKS; i++) {
+			if (!running[i]) {
+				continue;
+			}
+			// a slot removed, or removed and taken again, during the tick
+			// no longer holds this callback
+			if (taken[i] && !callbacks[i]) {
+				if (finished[i]) {
+					taken[i] = false;
+				} else {
+					callbacks[i] = std::move(running[i]);
+				}
+			}
+			running[i] = nullptr;
+		}
+
+		uint32_t exec = (uint32_t) (pros::micros() - start);
+		control_latency.record(exec);
+		stats.ticks++;
+		stats.lastJitterUs = jitter;
+		stats.lastExecUs = exec;
+		if (jitter > stats.maxJitterUs) {
+			stats.maxJitterUs = jitter;
+		}
+		if (exec > stats.maxExecUs) {
+			stats.maxExecUs = exec;
+		}
+		if (jitter + exec >= periodMs * 1000) {
+			stats.overruns++;
+		}
+	}
+}
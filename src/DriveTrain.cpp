@@ -0,0 +1,110 @@
+#include "DriveTrain.h"
+#include "Latency.h"
+
+#include <algorithm>
+
+static LatencySection drive_latency("drive_flush");
+
+DriveTrain::DriveTrain()
+    : motors{pros::Motor(LEFT_DRIVE_PORTS[0].port, GEARSET, LEFT_DRIVE_PORTS[0].reversed),
+             pros::Motor(LEFT_DRIVE_PORTS[1].port, GEARSET, LEFT_DRIVE_PORTS[1].reversed),
+             pros::Motor(LEFT_DRIVE_PORTS[2].port, GEARSET, LEFT_DRIVE_PORTS[2].reversed),
+             pros::Motor(RIGHT_DRIVE_PORTS[0].port, GEARSET, RIGHT_DRIVE_PORTS[0].reversed),
+             pros::Motor(RIGHT_DRIVE_PORTS[1].port, GEARSET, RIGHT_DRIVE_PORTS[1].reversed),
+             pros::Motor(RIGHT_DRIVE_PORTS[2].port, GEARSET, RIGHT_DRIVE_PORTS[2].reversed)} {}
+
+void DriveTrain::setPower(int left, int right) {
+	left = std::clamp(left, -MAX_POWER, MAX_POWER);
+	right = std::clamp(right, -MAX_POWER, MAX_POWER);
+	set(Mode::VOLTAGE, left * MAX_VOLTAGE / MAX_POWER, right * MAX_VOLTAGE / MAX_POWER);
+}
+
+void DriveTrain::setVoltage(int left, int right) {
+	set(Mode::VOLTAGE, std::clamp(left, -MAX_VOLTAGE, MAX_VOLTAGE), std::clamp(right, -MAX_VOLTAGE, MAX_VOLTAGE));
+}
+
+void DriveTrain::setVelocity(int left, int right) {
+	set(Mode::VELOCITY, left, right);
+}
+
+void DriveTrain::setPercent(double left, double right) {
+	left = std::clamp(left, -100.0, 100.0);
+	right = std::clamp(right, -100.0, 100.0);
+	set(Mode::VOLTAGE, (int32_t) (left * MAX_VOLTAGE / 100), (int32_t) (right * MAX_VOLTAGE / 100));
+}
+
+void DriveTrain::stop() {
+	set(Mode::VOLTAGE, 0, 0);
+}
+
+void DriveTrain::invalidate() {
+	for (Command& command : sent) {
+		command = Command();
+	}
+}
+
+void DriveTrain::set(Mode mode, int32_t left, int32_t right) {
+	for (int i = 0; i < SIDE_MOTORS; i++) {
+		pending[i] = {mode, left};
+		pending[SIDE_MOTORS + i] = {mode, right};
+	}
+	flush();
+}
+
+void DriveTrain::flush() {
+	ScopedTimer timer(drive_latency);
+	for (int i = 0; i < 2 * SIDE_MOTORS; i++) {
+		const Command& command = pending[i];
+		if (command.mode == sent[i].mode && command.value == sent[i].value) {
+			continue;
+		}
+		if (command.mode == Mode::VELOCITY) {
+			motors[i].move_velocity(command.value);
+		} else {
+			motors[i].move_voltage(command.value);
+		}
+		sent[i] = command;
+	}
+}
+
+void DriveTrain::setBrakeMode(pros::motor_brake_mode_e_t mode) {
+	for (pros::Motor& motor : motors) {
+		motor.set_brake_mode(mode);
+	}
+}
+
+void DriveTrain::setEncoderUnits(pros::motor_encoder_units_e_t units) {
+	for (pros::Motor& motor : motors) {
+		motor.set_encoder_units(units);
+	}
+}
+
+double DriveTrain::getLeftPosition() const {
+	return motors[0].get_position();
+}
+
+double DriveTrain::getRightPosition() const {
+	return motors[SIDE_MOTORS].get_position();
+}
+
+double DriveTrain::getLeftDistance() const {
+	return getLeftPosition() / TICKS_PER_INCH;
+}
+
+double DriveTrain::getRightDistance() const {
+	return getRightPosition() / TICKS_PER_INCH;
+}
+
+void DriveTrain::getDistances(std::array<double, 2 * SIDE_MOTORS>& distances) const {
+	for (int i = 0; i < 2 * SIDE_MOTORS; i++) {
+		distances[i] = motors[i].get_position() / TICKS_PER_INCH;
+	}
+}
+
+double DriveTrain::getLeftSpeed() const {
+	return motors[0].get_actual_velocity() * DRIVE_GEAR_RATIO * WHEEL_CIRCUMFERENCE / 60;
+}
+
+double DriveTrain::getRightSpeed() const {
+	return motors[SIDE_MOTORS].get_actual_velocity() * DRIVE_GEAR_RATIO * WHEEL_CIRCUMFERENCE / 60;
+}
@@ -0,0 +1,50 @@
+#include "DriverInput.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+int SlewLimiter::step(int target) {
+	// reversing drops straight to zero, then accelerates the other way
+	if (current != 0 && (target > 0) != (current > 0)) {
+		current = 0;
+	}
+	if (std::abs(target) <= std::abs(current)) {
+		current = target;
+	} else {
+		current += std::clamp(target - current, -maxStep, maxStep);
+	}
+	return current;
+}
+
+DriverInput::DriverInput(const CurveTable& forwardCurve, const CurveTable& turnCurve, int slewPerTick)
+    : forwardCurve(forwardCurve), turnCurve(turnCurve), leftSlew(slewPerTick), rightSlew(slewPerTick) {}
+
+DriverInput::Output DriverInput::arcade(int forward, int turn) {
+	int f = applyCurve(forwardCurve, forward);
+	int t = applyCurve(turnCurve, turn);
+	return mix(f + t, f - t);
+}
+
+DriverInput::Output DriverInput::curvature(int forward, int turn, int quickTurnThreshold) {
+	int f = applyCurve(forwardCurve, forward);
+	int t = applyCurve(turnCurve, turn);
+	if (std::abs(f) < quickTurnThreshold) {
+		return mix(t, -t);
+	}
+	int scaled = std::abs(f) * t / curve::MAX;
+	return mix(f + scaled, f - scaled);
+}
+
+void DriverInput::reset() {
+	leftSlew.reset();
+	rightSlew.reset();
+}
+
+DriverInput::Output DriverInput::mix(int left, int right) {
+	int largest = std::max(std::abs(left), std::abs(right));
+	if (largest > curve::MAX) {
+		left = left * curve::MAX / largest;
+		right = right * curve::MAX / largest;
+	}
+	return {leftSlew.step(left), rightSlew.step(right)};
+}
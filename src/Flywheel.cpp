@@ -0,0 +1,96 @@
+#include "Flywheel.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr double MAX_VOLTAGE = 12000;
+// speed is fitted over the last 7 readings, 60 ms, with a quadratic so it
+// does not lag while spinning up
+static constexpr int VELOCITY_WINDOW = 7;
+static constexpr VelocityEstimator::Method VELOCITY_METHOD = VelocityEstimator::Method::SAVITZKY_GOLAY;
+
+Flywheel::Flywheel(uint8_t port, const Gains& gains, double filterAlpha, uint32_t periodMs)
+    : motor(port), gains(gains), periodMs(periodMs),
+      // a green cartridge until loop() reads the real one
+      estimator(VelocityEstimator::rawCountsPerRev(pros::E_MOTOR_GEARSET_18), VELOCITY_WINDOW, VELOCITY_METHOD),
+      filter(filterAlpha) {}
+
+void Flywheel::start(uint32_t priority) {
+	if (task == nullptr) {
+		task = new pros::Task([this] { loop(); }, priority, TASK_STACK_DEPTH_DEFAULT, "flywheel");
+	}
+}
+
+void Flywheel::setTarget(int32_t rpm) {
+	target = rpm;
+}
+
+void Flywheel::loop() {
+	// raw counts per turn depend on the cartridge, which is only known once
+	// the motor is plugged in
+	estimator.setCountsPerRev(VelocityEstimator::rawCountsPerRev(motor.get_gearing()));
+	uint32_t wakeTime = pros::millis();
+	while (true) {
+		step();
+		pros::Task::delay_until(&wakeTime, periodMs);
+	}
+}
+
+void Flywheel::step() {
+	int32_t newTarget = target;
+	if (newTarget != activeTarget) {
+		// new setpoint: start from the feedforward guess rather than the old output
+		activeTarget = newTarget;
+		tbh = gains.kV * activeTarget;
+		output = tbh;
+		ticksInTolerance = 0;
+		atSpeed = false;
+		recovering = false;
+	}
+
+	// the motor reports every 10 ms, the same as this loop, so some ticks have
+	// no new reading and reuse the last estimate
+	if (estimator.update(motor)) {
+		velocity = filter.filter(estimator.getVelocity());
+	}
+	double measured = velocity;
+
+	// error measured in the direction of travel so negative targets work the same
+	double direction = activeTarget < 0 ? -1 : 1;
+	double error = direction * (activeTarget - measured);
+
+	double voltage;
+	if (error > gains.bangBangError) {
+		voltage = direction * MAX_VOLTAGE;
+	} else {
+		// take back half: integrate the error, and on every zero crossing
+		// jump to halfway between the current output and the last crossing
+		output += direction * gains.tbhGain * error;
+		if ((error > 0) != (lastError > 0)) {
+			output = (output + tbh) / 2;
+			tbh = output;
+		}
+		output = std::clamp(output, -MAX_VOLTAGE, MAX_VOLTAGE);
+		voltage = output;
+	}
+	lastError = error;
+	motor.move_voltage((int32_t) voltage);
+
+	if (std::fabs(error) <= gains.tolerance) {
+		ticksInTolerance++;
+	} else {
+		ticksInTolerance = 0;
+	}
+
+	if (atSpeed && error > gains.shotDrop) {
+		atSpeed = false;
+		recovering = true;
+		shotTime = pros::millis();
+	} else if (!atSpeed && ticksInTolerance >= gains.settleTicks) {
+		atSpeed = true;
+		if (recovering) {
+			recovering = false;
+			lastRecoveryTime = pros::millis() - shotTime;
+		}
+	}
+}
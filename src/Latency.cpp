@@ -0,0 +1,85 @@
+#include "Latency.h"
+
+static constexpr int MAX_SECTIONS = 16;
+static LatencySection* sections[MAX_SECTIONS];
+static int section_count = 0;
+
+LatencySection::LatencySection(const char* name) : name(name) {
+	if (section_count < MAX_SECTIONS) {
+		sections[section_count++] = this;
+	} else {
+		printf("latency: %d sections already registered, %s not tracked\n", MAX_SECTIONS, name);
+	}
+}
+
+int LatencySection::bucketOf(uint32_t micros) {
+	if (micros < SUB_BUCKETS) {
+		return micros;
+	}
+	// top two bits below the leading one pick the sub bucket
+	int octave = 31 - __builtin_clz(micros);
+	int sub = (micros >> (octave - 2)) & (SUB_BUCKETS - 1);
+	int bucket = (octave - 1) * SUB_BUCKETS + sub;
+	return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+uint32_t LatencySection::bucketLimit(int bucket) {
+	if (bucket < SUB_BUCKETS) {
+		return bucket;
+	}
+	int octave = bucket / SUB_BUCKETS + 1;
+	int sub = bucket % SUB_BUCKETS;
+	return ((uint32_t) (SUB_BUCKETS + sub + 1) << (octave - 2)) - 1;
+}
+
+void LatencySection::record(uint32_t micros) {
+	buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	total.fetch_add(micros, std::memory_order_relaxed);
+	uint32_t seen = max.load(std::memory_order_relaxed);
+	while (micros > seen && !max.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+	}
+}
+
+void LatencySection::reset() {
+	for (std::atomic<uint32_t>& bucket : buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	count.store(0, std::memory_order_relaxed);
+	max.store(0, std::memory_order_relaxed);
+	total.store(0, std::memory_order_relaxed);
+}
+
+uint32_t LatencySection::getMean() const {
+	uint32_t samples = getCount();
+	return samples ? (uint32_t) (total.load(std::memory_order_relaxed) / samples) : 0;
+}
+
+uint32_t LatencySection::getPercentile(double percentile) const {
+	uint32_t target = (uint32_t) (getCount() * percentile / 100);
+	uint32_t highest = getMax();
+	uint32_t seen = 0;
+	for (int i = 0; i < BUCKETS; i++) {
+		seen += buckets[i].load(std::memory_order_relaxed);
+		if (seen > target) {
+			return bucketLimit(i) < highest ? bucketLimit(i) : highest;
+		}
+	}
+	return highest;
+}
+
+void LatencySection::dumpAll() {
+	printf("%-16s %8s %8s %8s %8s %8s\n", "section", "count", "mean_us", "p50_us", "p99_us", "max_us");
+	for (int i = 0; i < section_count; i++) {
+		const LatencySection& section = *sections[i];
+		printf("%-16s %8lu %8lu %8lu %8lu %8lu\n", section.name, (unsigned long) section.getCount(),
+		       (unsigned long) section.getMean(), (unsigned long) section.getPercentile(50),
+		       (unsigned long) section.getPercentile(99), (unsigned long) section.getMax());
+	}
+}
+
+void LatencySection::resetAll() {
+	for (int i = 0; i < section_count; i++) {
+		sections[i]->reset();
+	}
+}
@@ -0,0 +1,376 @@
+#include "MatchRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static constexpr int NUM_BUTTONS = 12; // L1 through A
+static const uint8_t MAGIC[4] = {'C', 'P', 'V', 'X'};
+
+const char* MatchRecorder::replayPath = nullptr;
+MatchRecorder::ReplayHook MatchRecorder::replayHook = nullptr;
+
+static int put_varint(uint8_t* out, uint32_t value) {
+	int n = 0;
+	while (value >= 0x80) {
+		out[n++] = (uint8_t) (value | 0x80);
+		value >>= 7;
+	}
+	out[n++] = (uint8_t) value;
+	return n;
+}
+
+static bool get_varint(const uint8_t*& in, const uint8_t* end, uint32_t& value) {
+	value = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (in >= end) {
+			return false;
+		}
+		uint8_t byte = *in++;
+		value |= (uint32_t) (byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// small changes of either sign encode to small varints
+static int put_delta(uint8_t* out, int32_t previous, int32_t value) {
+	int32_t delta = (int32_t) ((uint32_t) value - (uint32_t) previous);
+	return put_varint(out, ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31));
+}
+
+static bool get_delta(const uint8_t*& in, const uint8_t* end, int32_t previous, int32_t& value) {
+	uint32_t zigzag;
+	if (!get_varint(in, end, zigzag)) {
+		return false;
+	}
+	int32_t delta = (int32_t) (zigzag >> 1) ^ -(int32_t) (zigzag & 1);
+	value = (int32_t) ((uint32_t) previous + (uint32_t) delta);
+	return true;
+}
+
+int MatchLog::encode(const MatchFrame& previous, const MatchFrame& frame, int motorCount, uint8_t* out) {
+	int n = put_varint(out, frame.time - previous.time);
+	for (int i = 0; i < 4; i++) {
+		n += put_delta(out + n, previous.analog[i], frame.analog[i]);
+	}
+	n += put_varint(out + n, previous.digital ^ frame.digital);
+	// new presses are rare, store them as is
+	n += put_varint(out + n, frame.newPress);
+	for (int i = 0; i < motorCount; i++) {
+		n += put_delta(out + n, previous.position[i], frame.position[i]);
+		n += put_delta(out + n, previous.velocity[i], frame.velocity[i]);
+		n += put_delta(out + n, previous.current[i], frame.current[i]);
+		n += put_delta(out + n, previous.voltage[i], frame.voltage[i]);
+	}
+	n += put_delta(out + n, previous.rotation, frame.rotation);
+	n += put_delta(out + n, previous.rate, frame.rate);
+	return n;
+}
+
+int MatchLog::decode(const MatchFrame& previous, const uint8_t* in, const uint8_t* end, int motorCount,
+                     MatchFrame& frame) {
+	const uint8_t* start = in;
+	uint32_t value;
+	int32_t analog;
+	if (!get_varint(in, end, value)) {
+		return 0;
+	}
+	frame.time = previous.time + value;
+	for (int i = 0; i < 4; i++) {
+		if (!get_delta(in, end, previous.analog[i], analog)) {
+			return 0;
+		}
+		frame.analog[i] = (int8_t) analog;
+	}
+	if (!get_varint(in, end, value)) {
+		return 0;
+	}
+	frame.digital = previous.digital ^ (uint16_t) value;
+	if (!get_varint(in, end, value)) {
+		return 0;
+	}
+	frame.newPress = (uint16_t) value;
+	for (int i = 0; i < motorCount; i++) {
+		if (!get_delta(in, end, previous.position[i], frame.position[i]) ||
+		    !get_delta(in, end, previous.velocity[i], frame.velocity[i]) ||
+		    !get_delta(in, end, previous.current[i], frame.current[i]) ||
+		    !get_delta(in, end, previous.voltage[i], frame.voltage[i])) {
+			return 0;
+		}
+	}
+	if (!get_delta(in, end, previous.rotation, frame.rotation) || !get_delta(in, end, previous.rate, frame.rate)) {
+		return 0;
+	}
+	return (int) (in - start);
+}
+
+MatchReader::~MatchReader() {
+	close();
+}
+
+bool MatchReader::open(const char* path) {
+	close();
+	file = fopen(path, "rb");
+	if (file == nullptr) {
+		return false;
+	}
+	uint8_t header[6];
+	if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, MAGIC, 4) != 0 ||
+	    header[4] != MatchLog::VERSION || header[5] > MatchFrame::MAX_MOTORS) {
+		close();
+		return false;
+	}
+	motorCount = header[5];
+	if (fread(ports, 1, motorCount, file) != (size_t) motorCount || fread(&imuPort, 1, 1, file) != 1) {
+		close();
+		return false;
+	}
+	blockLength = 0;
+	offset = 0;
+	return true;
+}
+
+void MatchReader::close() {
+	if (file != nullptr) {
+		fclose(file);
+		file = nullptr;
+	}
+}
+
+bool MatchReader::readBlock() {
+	uint8_t length[2];
+	if (file == nullptr || fread(length, 1, 2, file) != 2) {
+		return false;
+	}
+	blockLength = length[0] | length[1] << 8;
+	if (blockLength > MatchLog::BLOCK_SIZE || fread(block, 1, blockLength, file) != (size_t) blockLength) {
+		return false;
+	}
+	offset = 0;
+	previous = MatchFrame();
+	return true;
+}
+
+bool MatchReader::next(MatchFrame& frame) {
+	while (true) {
+		if (offset >= blockLength && !readBlock()) {
+			return false;
+		}
+		int n = MatchLog::decode(previous, block + offset, block + blockLength, motorCount, frame);
+		if (n == 0) {
+			// truncated block, the next one starts fresh
+			offset = blockLength;
+			continue;
+		}
+		offset += n;
+		previous = frame;
+		return true;
+	}
+}
+
+MatchRecorder::MatchRecorder(pros::Controller& controller, std::initializer_list<uint8_t> motorPorts,
+                             uint8_t imuPort)
+    : controller(controller), imuPort(imuPort) {
+	for (uint8_t port : motorPorts) {
+		if (motorCount < MatchFrame::MAX_MOTORS) {
+			ports[motorCount++] = port;
+		}
+	}
+	for (std::atomic<uint8_t>& state : states) {
+		state = FREE;
+	}
+}
+
+void MatchRecorder::replayFrom(const char* path, ReplayHook hook) {
+	replayPath = path;
+	replayHook = hook;
+}
+
+bool MatchRecorder::start(uint32_t priority) {
+	startTime = pros::millis();
+	frames = 0;
+	dropped = 0;
+	if (replayPath != nullptr) {
+		replaying = replay.open(replayPath);
+		replayDone = !replaying;
+		return replaying;
+	}
+	if (file != nullptr) {
+		return true;
+	}
+	if (!pros::usd::is_installed()) {
+		return false;
+	}
+
+	char path[64];
+	int index = 0;
+	for (; index < 1000; index++) {
+		snprintf(path, sizeof(path), USD_ROOT "match%03d.bin", index);
+		FILE* existing = fopen(path, "rb");
+		if (existing == nullptr) {
+			break;
+		}
+		fclose(existing);
+	}
+	if (index == 1000 || (file = fopen(path, "wb")) == nullptr) {
+		return false;
+	}
+	fwrite(MAGIC, 1, 4, file);
+	uint8_t header[2] = {MatchLog::VERSION, (uint8_t) motorCount};
+	fwrite(header, 1, 2, file);
+	fwrite(ports, 1, motorCount, file);
+	fwrite(&imuPort, 1, 1, file);
+	fflush(file);
+
+	for (std::atomic<uint8_t>& state : states) {
+		state = FREE;
+	}
+	filling = 0;
+	writing = 0;
+	if (writer == nullptr) {
+		writer = new pros::Task([this] { writeLoop(); }, priority, TASK_STACK_DEPTH_DEFAULT, "match_log");
+	}
+	return true;
+}
+
+void MatchRecorder::stop() {
+	if (replaying) {
+		replay.close();
+		replaying = false;
+		return;
+	}
+	if (file == nullptr) {
+		return;
+	}
+	if (states[filling] == FILLING) {
+		if (lengths[filling] > 0) {
+			finishBlock();
+		} else {
+			states[filling] = FREE;
+		}
+	}
+	// disabled() has time to wait for the card
+	for (std::atomic<uint8_t>& state : states) {
+		while (state == FULL) {
+			pros::delay(5);
+		}
+	}
+	fclose(file);
+	file = nullptr;
+	// a log with gaps replays out of step with what the driver saw
+	printf("match log: %lu frames, %lu dropped\n", (unsigned long) frames, (unsigned long) dropped);
+}
+
+void MatchRecorder::capture() {
+	if (replaying) {
+		if (!replay.next(frame)) {
+			frame = MatchFrame();
+			replayDone = true;
+			return;
+		}
+		// line the loop up with the recording so its own timers match
+		uint32_t now = pros::millis() - startTime;
+		if (frame.time > now) {
+			pros::delay(frame.time - now);
+		}
+		replayHook(frame, replay);
+		frames++;
+		return;
+	}
+	read(frame);
+	if (file != nullptr) {
+		append(frame);
+	}
+}
+
+// PROS_ERR_F and other nonsense reads as zero
+static int32_t to_fixed(double value, double scale) {
+	if (!std::isfinite(value) || value == PROS_ERR_F) {
+		return 0;
+	}
+	return (int32_t) std::lround(std::clamp(value * scale, -2e9, 2e9));
+}
+
+void MatchRecorder::read(MatchFrame& frame) {
+	frame.time = pros::millis() - startTime;
+	for (int i = 0; i < 4; i++) {
+		int32_t value = controller.get_analog((pros::controller_analog_e_t) i);
+		frame.analog[i] = (int8_t) (value == PROS_ERR ? 0 : std::clamp(value, -127, 127));
+	}
+	frame.digital = 0;
+	frame.newPress = 0;
+	for (int i = 0; i < NUM_BUTTONS; i++) {
+		auto button = (pros::controller_digital_e_t) (pros::E_CONTROLLER_DIGITAL_L1 + i);
+		if (controller.get_digital(button) == 1) {
+			frame.digital |= 1 << i;
+		}
+		if (controller.get_digital_new_press(button) == 1) {
+			frame.newPress |= 1 << i;
+		}
+	}
+	for (int i = 0; i < motorCount; i++) {
+		uint32_t timestamp;
+		frame.position[i] = pros::c::motor_get_raw_position(ports[i], &timestamp);
+		frame.velocity[i] = to_fixed(pros::c::motor_get_actual_velocity(ports[i]), 100);
+		frame.current[i] = pros::c::motor_get_current_draw(ports[i]);
+		frame.voltage[i] = pros::c::motor_get_voltage(ports[i]);
+	}
+	frame.rotation = to_fixed(pros::c::imu_get_rotation(imuPort), 1000);
+	frame.rate = to_fixed(pros::c::imu_get_gyro_rate(imuPort).z, 100);
+}
+
+void MatchRecorder::append(const MatchFrame& frame) {
+	if (states[filling] == FILLING && lengths[filling] + MatchLog::MAX_FRAME_BYTES > MatchLog::BLOCK_SIZE) {
+		finishBlock();
+	}
+	if (states[filling] != FILLING) {
+		if (states[filling] != FREE) {
+			// every block is still waiting on the card
+			dropped++;
+			return;
+		}
+		states[filling] = FILLING;
+		lengths[filling] = 0;
+		previous = MatchFrame();
+	}
+	lengths[filling] += MatchLog::encode(previous, frame, motorCount, blocks[filling] + lengths[filling]);
+	previous = frame;
+	frames++;
+}
+
+void MatchRecorder::finishBlock() {
+	states[filling] = FULL;
+	filling = (filling + 1) % BLOCKS;
+	writer->notify();
+}
+
+void MatchRecorder::writeLoop() {
+	while (true) {
+		pros::Task::notify_take(true, TIMEOUT_MAX);
+		while (states[writing] == FULL) {
+			uint8_t length[2] = {(uint8_t) lengths[writing], (uint8_t) (lengths[writing] >> 8)};
+			fwrite(length, 1, 2, file);
+			fwrite(blocks[writing], 1, lengths[writing], file);
+			fflush(file);
+			states[writing] = FREE;
+			writing = (writing + 1) % BLOCKS;
+		}
+	}
+}
+
+int32_t MatchRecorder::analog(pros::controller_analog_e_t channel) const {
+	return channel >= 0 && channel < 4 ? frame.analog[channel] : 0;
+}
+
+bool MatchRecorder::digital(pros::controller_digital_e_t button) const {
+	int bit = button - pros::E_CONTROLLER_DIGITAL_L1;
+	return bit >= 0 && bit < NUM_BUTTONS && (frame.digital >> bit & 1);
+}
+
+bool MatchRecorder::newPress(pros::controller_digital_e_t button) const {
+	int bit = button - pros::E_CONTROLLER_DIGITAL_L1;
+	return bit >= 0 && bit < NUM_BUTTONS && (frame.newPress >> bit & 1);
+}
@@ -0,0 +1,216 @@
+#include "MotionProfile.h"
+
+#include <algorithm>
+#include <cmath>
+
+MotionProfile::MotionProfile(double distance, double maxVelocity, double maxAcceleration, double jerkTime)
+    : direction(distance < 0 ? -1 : 1), distance(std::fabs(distance)), acceleration(maxAcceleration),
+      jerkTime(std::max(jerkTime, 0.0)) {
+	// not enough room to reach maxVelocity, the profile becomes a triangle
+	if (this->distance * maxAcceleration < maxVelocity * maxVelocity) {
+		peakVelocity = std::sqrt(this->distance * maxAcceleration);
+	} else {
+		peakVelocity = maxVelocity;
+	}
+	accelTime = peakVelocity > 0 ? peakVelocity / acceleration : 0;
+	cruiseTime = peakVelocity > 0 ? (this->distance - peakVelocity * accelTime) / peakVelocity : 0;
+}
+
+double MotionProfile::trapezoidPosition(double t) const {
+	const double cruiseStart = accelTime;
+	const double decelStart = accelTime + cruiseTime;
+	if (t <= 0) {
+		return 0;
+	} else if (t < cruiseStart) {
+		return acceleration * t * t / 2;
+	} else if (t < decelStart) {
+		return acceleration * accelTime * accelTime / 2 + peakVelocity * (t - cruiseStart);
+	} else if (t < decelStart + accelTime) {
+		double tau = t - decelStart;
+		return distance - acceleration * (accelTime - tau) * (accelTime - tau) / 2;
+	}
+	return distance;
+}
+
+double MotionProfile::trapezoidIntegral(double t) const {
+	const double cruiseStart = accelTime;
+	const double decelStart = accelTime + cruiseTime;
+	const double end = decelStart + accelTime;
+	const double accelDistance = acceleration * accelTime * accelTime / 2;
+
+	double integral = 0;
+	if (t <= 0) {
+		return 0;
+	}
+
+	double tau = std::min(t, cruiseStart);
+	integral += acceleration * tau * tau * tau / 6;
+	if (t <= cruiseStart) {
+		return integral;
+	}
+
+	tau = std::min(t, decelStart) - cruiseStart;
+	integral += accelDistance * tau + peakVelocity * tau * tau / 2;
+	if (t <= decelStart) {
+		return integral;
+	}
+
+	const double decelPosition = accelDistance + peakVelocity * cruiseTime;
+	tau = std::min(t, end) - decelStart;
+	integral += decelPosition * tau + peakVelocity * tau * tau / 2 - acceleration * tau * tau * tau / 6;
+	if (t <= end) {
+		return integral;
+	}
+
+	return integral + distance * (t - end);
+}
+
+ProfileState MotionProfile::trapezoidState(double t) const {
+	const double cruiseStart = accelTime;
+	const double decelStart = accelTime + cruiseTime;
+	const double end = decelStart + accelTime;
+
+	ProfileState state;
+	state.position = trapezoidPosition(t);
+	if (t <= 0 || t >= end) {
+		return state;
+	} else if (t < cruiseStart) {
+		state.velocity = acceleration * t;
+		state.acceleration = acceleration;
+	} else if (t < decelStart) {
+		state.velocity = peakVelocity;
+	} else {
+		state.velocity = acceleration * (end - t);
+		state.acceleration = -acceleration;
+	}
+	return state;
+}
+
+ProfileState MotionProfile::sample(double t) const {
+	ProfileState state;
+	if (jerkTime > 0) {
+		// moving average of the trapezoid over [t - jerkTime, t]
+		state.position = (trapezoidIntegral(t) - trapezoidIntegral(t - jerkTime)) / jerkTime;
+		state.velocity = (trapezoidPosition(t) - trapezoidPosition(t - jerkTime)) / jerkTime;
+		state.acceleration = (trapezoidState(t).velocity - trapezoidState(t - jerkTime).velocity) / jerkTime;
+	} else {
+		state = trapezoidState(t);
+	}
+
+	state.position *= direction;
+	state.velocity *= direction;
+	state.acceleration *= direction;
+	return state;
+}
+
+double Feedforward::calculate(double velocity, double acceleration) const {
+	double staticFriction = 0;
+	if (velocity > 0) {
+		staticFriction = kS;
+	} else if (velocity < 0) {
+		staticFriction = -kS;
+	}
+	return staticFriction + kV * velocity + kA * acceleration;
+}
+
+GainSchedule::GainSchedule(const PidGains& gains) : count(1) {
+	points[0] = {0, gains};
+}
+
+GainSchedule::GainSchedule(Key key, std::initializer_list<Point> points)
+    : GainSchedule(key, points.begin(), (int) points.size()) {}
+
+GainSchedule::GainSchedule(Key key, const Point* points, int count) : key(key) {
+	for (int i = 0; i < count && this->count < MAX_POINTS; i++) {
+		this->points[this->count++] = points[i];
+	}
+}
+
+PidGains GainSchedule::lookup(double value) const {
+	if (count == 0) {
+		return {0, 0, 0};
+	}
+	if (value <= points[0].key) {
+		return points[0].gains;
+	}
+	for (int i = 1; i < count; i++) {
+		const Point& low = points[i - 1];
+		const Point& high = points[i];
+		if (value < high.key) {
+			double f = (value - low.key) / (high.key - low.key);
+			return {low.gains.kP + f * (high.gains.kP - low.gains.kP), low.gains.kI + f * (high.gains.kI - low.gains.kI),
+			        low.gains.kD + f * (high.gains.kD - low.gains.kD)};
+		}
+	}
+	return points[count - 1].gains;
+}
+
+TrackingController::TrackingController(const Feedforward& feedforward, const GainSchedule& schedule,
+                                       double maxVoltage, const SetpointWeights& weights)
+    : feedforward(feedforward), schedule(schedule), maxVoltage(maxVoltage), weights(weights) {}
+
+double TrackingController::update(double dt, const ProfileState& reference, double position, double velocity,
+                                  double battery) {
+	error = reference.position - position;
+	gains = schedule.lookup(schedule.getKey() == GainSchedule::Key::ERROR ? std::fabs(error) : battery);
+
+	double output = feedforward.calculate(reference.velocity, reference.acceleration) +
+	                gains.kP * (weights.proportional * reference.position - position) +
+	                gains.kD * (weights.derivative * reference.velocity - velocity);
+
+	// the integral is kept in millivolts, so a scheduled kI only changes how
+	// fast it grows, not what it has already built up; it only grows while
+	// the output can still respond, so it cannot wind up while saturated
+	double withIntegral = output + integral + gains.kI * error * dt;
+	if (std::fabs(withIntegral) < maxVoltage || (withIntegral > 0) != (error > 0)) {
+		integral += gains.kI * error * dt;
+	}
+	output += integral;
+	return std::clamp(output, -maxVoltage, maxVoltage);
+}
+
+void TrackingController::reset() {
+	integral = 0;
+	error = 0;
+}
+
+ProfileFollower::ProfileFollower(const MotionProfile& profile, const Feedforward& feedforward, const Gains& gains,
+                                 double maxVoltage, double tolerance, double timeout)
+    : ProfileFollower(profile, feedforward, GainSchedule({gains.kP, 0, gains.kD}), maxVoltage, tolerance, timeout) {}
+
+ProfileFollower::ProfileFollower(const MotionProfile& profile, const Feedforward& feedforward,
+                                 const GainSchedule& schedule, double maxVoltage, double tolerance, double timeout)
+    : profile(profile), controller(feedforward, schedule, maxVoltage), tolerance(tolerance), timeout(timeout) {}
+
+double ProfileFollower::update(double t, double position, double velocity) {
+	reference = profile.sample(t);
+	error = reference.position - position;
+
+	const double duration = profile.getDuration();
+	if (t >= duration && (std::fabs(error) <= tolerance || t >= duration + timeout)) {
+		finished = true;
+		return 0;
+	}
+
+	double dt = t - lastTime;
+	lastTime = t;
+	return controller.update(dt, reference, position, velocity);
+}
+
+MoveScore::MoveScore(double distance, double tolerance, double stoppedSpeed)
+    : distance(distance), tolerance(tolerance), stoppedSpeed(stoppedSpeed), error(distance) {}
+
+void MoveScore::add(double t, double dt, double position, double velocity) {
+	error = distance - position;
+	this->velocity = velocity;
+	itae += t * std::fabs(error) * dt;
+	overshoot = std::max(overshoot, distance < 0 ? error : -error);
+	elapsed = t + dt;
+	if (std::fabs(error) > tolerance) {
+		settleTime = elapsed;
+	}
+}
+
+bool MoveScore::isSettled() const {
+	return std::fabs(error) <= tolerance && std::fabs(velocity) <= stoppedSpeed;
+}
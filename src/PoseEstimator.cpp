@@ -0,0 +1,191 @@
+#include "PoseEstimator.h"
+
+#include <cmath>
+
+using okapi::Matrix;
+
+static constexpr double PI = 3.14159265358979;
+static constexpr double RADIANS_PER_DEGREE = PI / 180;
+
+// chi-squared values that reject 1% of good readings
+static constexpr double GATE_1 = 6.63;
+static constexpr double GATE_3 = 11.34;
+
+// distance sensors are unreliable at grazing angles, ignore readings more
+// than 60 degrees off the wall's normal
+static constexpr double MIN_INCIDENCE_COSINE = 0.5;
+
+// how well reset() knows the pose: half an inch, one degree, at rest, and
+// the IMU has not drifted yet
+static const std::array<double, PoseEstimator::STATES> RESET_VARIANCE = {
+    0.25, 0.25, RADIANS_PER_DEGREE * RADIANS_PER_DEGREE, 0.01, 0.0001, 0};
+
+// wrap to [-pi, pi]
+static double wrapAngle(double angle) {
+	return std::remainder(angle, 2 * PI);
+}
+
+PoseEstimator::PoseEstimator(double trackWidth, const Noise& noise)
+    : trackWidth(trackWidth), noise(noise), filter(Filter::State(), Filter::Covariance::diagonal(RESET_VARIANCE)) {}
+
+void PoseEstimator::reset(const Pose& pose) {
+	Filter::State state;
+	state[X] = pose.x;
+	state[Y] = pose.y;
+	state[HEADING] = pose.heading;
+	filter.reset(state, Filter::Covariance::diagonal(RESET_VARIANCE));
+	haveImuOffset = false;
+}
+
+void PoseEstimator::predict(double dt) {
+	const Filter::State& state = filter.getState();
+	const double v = state[VELOCITY];
+	const double w = state[TURN_RATE];
+	// move along the chord of the arc, at the heading halfway through the step
+	const double middle = state[HEADING] + w * dt / 2;
+	const double c = std::cos(middle);
+	const double s = std::sin(middle);
+
+	Filter::State next = state;
+	next[X] += v * dt * c;
+	next[Y] += v * dt * s;
+	next[HEADING] += w * dt;
+
+	Matrix<STATES, STATES> F = Matrix<STATES, STATES>::identity();
+	F(X, HEADING) = -v * dt * s;
+	F(X, VELOCITY) = dt * c;
+	F(X, TURN_RATE) = -v * dt * s * dt / 2;
+	F(Y, HEADING) = v * dt * c;
+	F(Y, VELOCITY) = dt * s;
+	F(Y, TURN_RATE) = v * dt * c * dt / 2;
+	F(HEADING, TURN_RATE) = dt;
+
+	// white noise acceleration, integrated over the step into each state
+	Matrix<STATES, 1> linear;
+	linear[X] = dt * dt / 2 * c;
+	linear[Y] = dt * dt / 2 * s;
+	linear[VELOCITY] = dt;
+	Matrix<STATES, 1> angular;
+	angular[HEADING] = dt * dt / 2;
+	angular[TURN_RATE] = dt;
+	Filter::Covariance Q = linear * linear.transpose() * (noise.acceleration * noise.acceleration) +
+	                       angular * angular.transpose() * (noise.angularAcceleration * noise.angularAcceleration);
+	const double drift = noise.imuDrift * RADIANS_PER_DEGREE;
+	Q(IMU_DRIFT, IMU_DRIFT) = drift * drift * dt;
+
+	filter.predict(next, F, Q);
+}
+
+void PoseEstimator::updateDrive(const std::array<double, DRIVE_ENCODERS>& distances, double dt) {
+	if (!haveDistances || dt <= 0) {
+		lastDistances = distances;
+		haveDistances = true;
+		return;
+	}
+
+	const Filter::State& state = filter.getState();
+	constexpr int SIDE = DRIVE_ENCODERS / 2;
+	Matrix<DRIVE_ENCODERS, 1> innovation;
+	Matrix<DRIVE_ENCODERS, STATES> H;
+	Matrix<DRIVE_ENCODERS, DRIVE_ENCODERS> R;
+	for (int i = 0; i < DRIVE_ENCODERS; i++) {
+		// left wheels see v - w * track / 2, right wheels v + w * track / 2
+		const double side = i < SIDE ? -0.5 : 0.5;
+		const double speed = (distances[i] - lastDistances[i]) / dt;
+		innovation[i] = speed - (state[VELOCITY] + side * trackWidth * state[TURN_RATE]);
+		H(i, VELOCITY) = 1;
+		H(i, TURN_RATE) = side * trackWidth;
+		// the motors on a side are geared together, so slip is common to them
+		for (int j = 0; j < DRIVE_ENCODERS; j++) {
+			if (i / SIDE == j / SIDE) {
+				R(i, j) = noise.slip * noise.slip;
+			}
+		}
+		R(i, i) += noise.encoder * noise.encoder;
+	}
+	lastDistances = distances;
+
+	filter.update(innovation, H, R);
+}
+
+void PoseEstimator::updateImu(double rotation, double rate) {
+	const Filter::State& state = filter.getState();
+	const double heading = -rotation * RADIANS_PER_DEGREE;
+	if (!haveImuOffset) {
+		imuOffset = state[HEADING] + state[IMU_DRIFT] - heading;
+		haveImuOffset = true;
+	}
+
+	// the IMU reads the heading plus its drift
+	Matrix<2, 1> innovation;
+	innovation[0] = wrapAngle(heading + imuOffset - state[HEADING] - state[IMU_DRIFT]);
+	innovation[1] = -rate * RADIANS_PER_DEGREE - state[TURN_RATE];
+	Matrix<2, STATES> H;
+	H(0, HEADING) = 1;
+	H(0, IMU_DRIFT) = 1;
+	H(1, TURN_RATE) = 1;
+	const double headingNoise = noise.imuHeading * RADIANS_PER_DEGREE;
+	const double rateNoise = noise.imuRate * RADIANS_PER_DEGREE;
+	Matrix<2, 2> R = Matrix<2, 2>::diagonal({headingNoise * headingNoise, rateNoise * rateNoise});
+
+	filter.update(innovation, H, R);
+}
+
+bool PoseEstimator::updatePose(const Pose& pose, double positionNoise, double headingNoise) {
+	const Filter::State& state = filter.getState();
+	Matrix<3, 1> innovation;
+	innovation[0] = pose.x - state[X];
+	innovation[1] = pose.y - state[Y];
+	innovation[2] = wrapAngle(pose.heading - state[HEADING]);
+	Matrix<3, STATES> H;
+	H(0, X) = 1;
+	H(1, Y) = 1;
+	H(2, HEADING) = 1;
+	Matrix<3, 3> R = Matrix<3, 3>::diagonal(
+	    {positionNoise * positionNoise, positionNoise * positionNoise, headingNoise * headingNoise});
+
+	return filter.update(innovation, H, R, GATE_3);
+}
+
+bool PoseEstimator::updateDistance(const DistanceSensor& sensor, const Wall& wall, double distance) {
+	const Filter::State& state = filter.getState();
+	const double c = std::cos(state[HEADING]);
+	const double s = std::sin(state[HEADING]);
+	// sensor position and beam direction on the field, and their derivatives
+	// with respect to heading
+	const double sensorX = state[X] + sensor.x * c - sensor.y * s;
+	const double sensorY = state[Y] + sensor.x * s + sensor.y * c;
+	const double dSensorX = -sensor.x * s - sensor.y * c;
+	const double dSensorY = sensor.x * c - sensor.y * s;
+	const double beamX = std::cos(state[HEADING] + sensor.angle);
+	const double beamY = std::sin(state[HEADING] + sensor.angle);
+
+	// the beam hits the wall where normal . (sensor + d * beam) == offset
+	const double gap = wall.offset - (wall.normalX * sensorX + wall.normalY * sensorY);
+	const double incidence = wall.normalX * beamX + wall.normalY * beamY;
+	if (std::fabs(incidence) < MIN_INCIDENCE_COSINE) {
+		return false;
+	}
+	const double expected = gap / incidence;
+	if (expected <= 0) {
+		return false;
+	}
+
+	const double dGap = -(wall.normalX * dSensorX + wall.normalY * dSensorY);
+	const double dIncidence = -wall.normalX * beamY + wall.normalY * beamX;
+	Matrix<1, 1> innovation;
+	innovation[0] = distance - expected;
+	Matrix<1, STATES> H;
+	H(0, X) = -wall.normalX / incidence;
+	H(0, Y) = -wall.normalY / incidence;
+	H(0, HEADING) = (dGap * incidence - gap * dIncidence) / (incidence * incidence);
+	Matrix<1, 1> R;
+	R(0, 0) = sensor.noise * sensor.noise;
+
+	return filter.update(innovation, H, R, GATE_1);
+}
+
+PoseEstimator::Pose PoseEstimator::getPose() const {
+	const Filter::State& state = filter.getState();
+	return {state[X], state[Y], wrapAngle(state[HEADING])};
+}
@@ -0,0 +1,112 @@
+#include "Telemetry.h"
+#include "Latency.h"
+
+#include <cstring>
+#include <mutex>
+
+static LatencySection lcd_latency("lcd_draw");
+
+Telemetry::Telemetry(uint32_t refreshMs) : refreshMs(refreshMs) {}
+
+void Telemetry::start(uint32_t priority) {
+	if (task == nullptr) {
+		task = new pros::Task([this] { loop(); }, priority, TASK_STACK_DEPTH_DEFAULT, "telemetry");
+	}
+}
+
+void Telemetry::publish(int line, const char* label, double value, int precision) {
+	Slot slot;
+	slot.type = Type::DOUBLE;
+	slot.precision = precision;
+	slot.label = label;
+	slot.d = value;
+	set(line, slot);
+}
+
+void Telemetry::publish(int line, const char* label, int value) {
+	Slot slot;
+	slot.type = Type::INT;
+	slot.label = label;
+	slot.i = value;
+	set(line, slot);
+}
+
+void Telemetry::publish(int line, const char* label, int first, int second) {
+	Slot slot;
+	slot.type = Type::INT_PAIR;
+	slot.label = label;
+	slot.pair[0] = first;
+	slot.pair[1] = second;
+	set(line, slot);
+}
+
+void Telemetry::publish(int line, const char* text) {
+	Slot slot;
+	slot.type = Type::TEXT;
+	slot.label = text;
+	set(line, slot);
+}
+
+void Telemetry::clear(int line) {
+	set(line, Slot());
+}
+
+void Telemetry::set(int line, const Slot& slot) {
+	if (line < 0 || line >= LINES) {
+		return;
+	}
+	std::lock_guard<pros::Mutex> lock(mutex);
+	published[line] = slot;
+	dirty = true;
+}
+
+void Telemetry::format(const Slot& slot, char* out) {
+	switch (slot.type) {
+	case Type::EMPTY:
+		out[0] = '\0';
+		break;
+	case Type::TEXT:
+		snprintf(out, LINE_LENGTH, "%s", slot.label);
+		break;
+	case Type::INT:
+		snprintf(out, LINE_LENGTH, "%s: %d", slot.label, slot.i);
+		break;
+	case Type::INT_PAIR:
+		snprintf(out, LINE_LENGTH, "%s: %d / %d", slot.label, slot.pair[0], slot.pair[1]);
+		break;
+	case Type::DOUBLE:
+		snprintf(out, LINE_LENGTH, "%s: %.*f", slot.label, slot.precision, slot.d);
+		break;
+	}
+}
+
+void Telemetry::loop() {
+	char line[LINE_LENGTH];
+	uint32_t wakeTime = pros::millis();
+
+	while (true) {
+		pros::Task::delay_until(&wakeTime, refreshMs);
+
+		{
+			std::lock_guard<pros::Mutex> lock(mutex);
+			if (!dirty) {
+				continue;
+			}
+			memcpy(snapshot, published, sizeof(snapshot));
+			dirty = false;
+		}
+
+		ScopedTimer timer(lcd_latency);
+		for (int i = 0; i < LINES; i++) {
+			format(snapshot[i], line);
+			if (strcmp(line, rendered[i]) != 0) {
+				memcpy(rendered[i], line, LINE_LENGTH);
+				if (line[0] == '\0') {
+					pros::c::lcd_clear_line(i);
+				} else {
+					pros::c::lcd_set_text(i, line);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#include "TurnController.h"
+
+#include <algorithm>
+#include <cmath>
+
+TurnController::TurnController(const Gains& gains, const Settle& settle, double maxVoltage)
+    : gains(gains), settle(settle), maxVoltage(maxVoltage),
+      window({settle.error, settle.error, settle.rate, settle.time}) {}
+
+double TurnController::update(double dt, double error, double rate) {
+	elapsed += dt;
+
+	settled = window.add(elapsed, error) && std::fabs(rate) <= settle.rate;
+	if (isFinished()) {
+		return 0;
+	}
+
+	// reset on crossing the target so the integral cannot push us past it
+	if (std::fabs(error) > gains.integralZone || (error > 0) != (lastError > 0)) {
+		integral = 0;
+	} else {
+		integral += error * dt;
+	}
+	lastError = error;
+
+	double output = gains.kP * error + gains.kI * integral - gains.kD * rate;
+	if (std::fabs(error) > settle.error) {
+		output += error > 0 ? gains.kS : -gains.kS;
+	}
+	return std::clamp(output, -maxVoltage, maxVoltage);
+}
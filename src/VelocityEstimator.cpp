@@ -0,0 +1,135 @@
+#include "VelocityEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+VelocityEstimator::VelocityEstimator(double countsPerRev, int window, Method method)
+    : countsPerRev(countsPerRev), window(std::clamp(window, method == Method::SLOPE ? 2 : 3, MAX_WINDOW)),
+      method(method) {}
+
+double VelocityEstimator::rawCountsPerRev(pros::motor_gearset_e_t gearset) {
+	switch (gearset) {
+	case pros::E_MOTOR_GEARSET_36:
+		return 1800;
+	case pros::E_MOTOR_GEARSET_06:
+		return 300;
+	default:
+		return 900;
+	}
+}
+
+bool VelocityEstimator::update(const pros::Motor& motor) {
+	uint32_t timestamp = 0;
+	int32_t position = motor.get_raw_position(&timestamp);
+	if (position == PROS_ERR) {
+		return false;
+	}
+	return addSample(position, timestamp);
+}
+
+bool VelocityEstimator::addSample(int32_t position, uint32_t timestamp) {
+	if (count > 0) {
+		int32_t age = (int32_t) (timestamp - times[newest()]);
+		if (age <= 0) {
+			// the motor has not reported since the last call
+			return false;
+		}
+		if ((uint32_t) age > MAX_GAP_MS) {
+			reset();
+		}
+	}
+
+	counts[head] = position;
+	times[head] = timestamp;
+	head = (head + 1) % MAX_WINDOW;
+	count = std::min(count + 1, window);
+
+	if (count >= 3) {
+		fitQuadratic();
+	} else if (count == 2) {
+		fitLine();
+	}
+	return true;
+}
+
+void VelocityEstimator::reset() {
+	head = 0;
+	count = 0;
+	velocity = 0;
+	acceleration = 0;
+}
+
+void VelocityEstimator::sample(int i, double& t, double& p) const {
+	const int slot = (head + MAX_WINDOW - count + i) % MAX_WINDOW;
+	t = (int32_t) (times[slot] - times[newest()]) / 1000.0;
+	p = (int32_t) (counts[slot] - counts[newest()]);
+}
+
+void VelocityEstimator::fitLine() {
+	double meanT = 0;
+	double meanP = 0;
+	for (int i = 0; i < count; i++) {
+		double t, p;
+		sample(i, t, p);
+		meanT += t;
+		meanP += p;
+	}
+	meanT /= count;
+	meanP /= count;
+
+	double stt = 0;
+	double stp = 0;
+	for (int i = 0; i < count; i++) {
+		double t, p;
+		sample(i, t, p);
+		stt += (t - meanT) * (t - meanT);
+		stp += (t - meanT) * (p - meanP);
+	}
+	double slope = stt > 0 ? stp / stt : 0;
+	velocity = slope * 60 / countsPerRev;
+}
+
+void VelocityEstimator::fitQuadratic() {
+	// p = a + b * u + c * u^2 with u the time from the window's mean time,
+	// which makes the sum of u zero and keeps the normal equations well
+	// conditioned
+	double meanT = 0;
+	for (int i = 0; i < count; i++) {
+		double t, p;
+		sample(i, t, p);
+		meanT += t;
+	}
+	meanT /= count;
+
+	double s2 = 0, s3 = 0, s4 = 0, t0 = 0, t1 = 0, t2 = 0;
+	for (int i = 0; i < count; i++) {
+		double t, p;
+		sample(i, t, p);
+		const double u = t - meanT;
+		s2 += u * u;
+		s3 += u * u * u;
+		s4 += u * u * u * u;
+		t0 += p;
+		t1 += u * p;
+		t2 += u * u * p;
+	}
+
+	// Cramer's rule on [n 0 s2; 0 s2 s3; s2 s3 s4] [a b c] = [t0 t1 t2]
+	const double n = count;
+	const double det = n * (s2 * s4 - s3 * s3) - s2 * s2 * s2;
+	if (std::fabs(det) <= 1e-12 * n * s2 * s4) {
+		fitLine();
+		acceleration = 0;
+		return;
+	}
+	const double b = (n * (t1 * s4 - s3 * t2) + s2 * (s3 * t0 - s2 * t1)) / det;
+	const double c = (n * (s2 * t2 - s3 * t1) - s2 * s2 * t0) / det;
+
+	acceleration = 2 * c * 60 / countsPerRev;
+	if (method == Method::SAVITZKY_GOLAY) {
+		// derivative at the newest reading, u = -meanT
+		velocity = (b - 2 * c * meanT) * 60 / countsPerRev;
+	} else {
+		fitLine();
+	}
+}
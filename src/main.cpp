@@ -1,43 +1,75 @@
 #include "main.h"
+#include "Command.h"
+#include "ControlScheduler.h"
+#include "DriveConstants.h"
+#include "DriveTrain.h"
+#include "DriverInput.h"
+#include "Flywheel.h"
+#include "Latency.h"
+#include "MatchRecorder.h"
+#include "MotionProfile.h"
+#include "PoseEstimator.h"
+#include "Telemetry.h"
+#include "TurnController.h"
 
 #define UPPER_FLYWHEEL 1
 #define INTAKE_WHEEL 10
 #define LOWER_FLYWHEEL 15
 
-// Backward motors are reversed relative to other motors
-#define RIGHT_FORWARD_DRIVE 20
-#define RIGHT_BACKWARD_DRIVE 19
-#define RIGHT_UPPER_DRIVE 18
-#define LEFT_FORWARD_DRIVE 11
-#define LEFT_BACKWARD_DRIVE 12
-#define LEFT_UPPER_DRIVE 13
-
 // Wing ports
 const char LEFT_WING_PORT = 'A'; // three wire
 const char RIGHT_WING_PORT = 'B';
 
 #define GYRO_PORT 16
 
+// Motion primitives run their control step from this fixed-rate task
+#define CONTROL_PERIOD_MS 10
+ControlScheduler control_scheduler(CONTROL_PERIOD_MS);
+// Autonomous commands, ticked from the control scheduler
+CommandScheduler command_scheduler;
+// LCD output, formatted and redrawn off the control path
+Telemetry telemetry;
+
 double gyro_offset = 0;
 pros::Imu gyro(GYRO_PORT);
 
 // Controller
 pros::Controller master(pros::E_CONTROLLER_MASTER);
-// Drive motors
-pros::Motor right_fwd_mtr(RIGHT_FORWARD_DRIVE);
-pros::Motor right_upp_mtr(RIGHT_UPPER_DRIVE);
-pros::Motor right_bwd_mtr(RIGHT_BACKWARD_DRIVE);
-pros::Motor left_fwd_mtr(LEFT_FORWARD_DRIVE);
-pros::Motor left_upp_mtr(LEFT_UPPER_DRIVE);
-pros::Motor left_bwd_mtr(LEFT_BACKWARD_DRIVE);
-// Flywheel and intake motor speed
-pros::Motor upper_flywheel_mtr(UPPER_FLYWHEEL);
+// Drive motors, wiring is in RobotSpecifics.h
+DriveTrain drive;
+// Flywheels run closed loop in their own tasks
+const Flywheel::Gains FLYWHEEL_GAINS = {20, 0.5, 100, 15, 40, 5};
+Flywheel upper_flywheel(UPPER_FLYWHEEL, FLYWHEEL_GAINS);
+Flywheel lower_flywheel(LOWER_FLYWHEEL, FLYWHEEL_GAINS);
+// Intake motor
 pros::Motor intake_mtr(INTAKE_WHEEL);
-pros::Motor lower_flywheel_mtr(LOWER_FLYWHEEL);
+
+// Driver stick shaping: 5 count deadband, cubic response, full power in ~170 ms
+constexpr CurveTable FORWARD_CURVE = makeCubicCurve(5, 0.6);
+constexpr CurveTable TURN_CURVE = makeCubicCurve(5, 0.8);
+DriverInput driver_input(FORWARD_CURVE, TURN_CURVE, 15);
 // Piston control for wings
 pros::ADIDigitalOut left_wing_piston(LEFT_WING_PORT);
 pros::ADIDigitalOut right_wing_piston(RIGHT_WING_PORT);
 
+// Driver control reads the controller through this so every match can be
+// logged to the SD card and replayed on the host
+MatchRecorder match_recorder(master,
+                             {LEFT_DRIVE_PORTS[0].port, LEFT_DRIVE_PORTS[1].port, LEFT_DRIVE_PORTS[2].port,
+                              RIGHT_DRIVE_PORTS[0].port, RIGHT_DRIVE_PORTS[1].port, RIGHT_DRIVE_PORTS[2].port,
+                              UPPER_FLYWHEEL, LOWER_FLYWHEEL, INTAKE_WHEEL},
+                             GYRO_PORT);
+
+// Per iteration timing for driver control; the sensor reads at the top of
+// the loop are timed separately from the whole loop body
+LatencySection opcontrol_latency("opcontrol");
+LatencySection opcontrol_io_latency("opcontrol_io");
+
+// LLEMU's left button prints every latency histogram to the terminal
+void on_left_button() {
+	LatencySection::dumpAll();
+}
+
 /**
  * A callback function for LLEMU's center button.
  *
@@ -48,9 +80,9 @@ void on_center_button() {
 	static bool pressed = false;
 	pressed = !pressed;
 	if (pressed) {
-		pros::lcd::set_text(2, "I was pressed!");
+		telemetry.publish(2, "I was pressed!");
 	} else {
-		pros::lcd::clear_line(2);
+		telemetry.clear(2);
 	}
 }
 
@@ -65,93 +97,210 @@ double getRotation() {
 	return getRawRotation() - gyro_offset;
 }
 
+// turn rate in degrees per second, clockwise like getRotation()
+double getRotationRate() {
+	double rate = gyro.get_gyro_rate().z;
+	return (rate == PROS_ERR_F ? 0 : -rate);
+}
+
 void resetRotation() {
 	gyro_offset = getRawRotation();
 }
 
-// positive left and right pow drives robot forward
-void moveDriveMotors(int leftPow, int rightPow) {
-	right_fwd_mtr.move(rightPow);
-	right_upp_mtr.move(-rightPow);
-	right_bwd_mtr.move(rightPow);
-	left_fwd_mtr.move(-leftPow);
-	left_upp_mtr.move(leftPow);
-	left_bwd_mtr.move(-leftPow);
+// Field pose from every drive encoder and the IMU, updated each control tick.
+// It starts at the origin facing +x, wherever the robot was at power on.
+PoseEstimator pose_estimator(DRIVE_TRACK_WIDTH, POSE_NOISE);
+LatencySection pose_latency("pose_update");
+
+// never finishes; shows the pose in inches on line 5
+bool pose_step(double dt) {
+	ScopedTimer timer(pose_latency);
+	std::array<double, PoseEstimator::DRIVE_ENCODERS> distances;
+	drive.getDistances(distances);
+	pose_estimator.predict(dt);
+	pose_estimator.updateDrive(distances, dt);
+	pose_estimator.updateImu(getRotation(), getRotationRate());
+	PoseEstimator::Pose pose = pose_estimator.getPose();
+	telemetry.publish(5, "Pose x / y in", (int) std::round(pose.x), (int) std::round(pose.y));
+	return false;
 }
 
-void drive_straight(double dist, int maxPow = 50) { //implementing a simple p controller for driving straight
-	//get internal motor encoders right motor
-	double right_pos = right_fwd_mtr.get_position();
-
-	double desired_val = (37.5 * dist) + right_pos;
-	int pow;
-	double p = 0.6;
-	double error = desired_val - right_pos;
-
-	while(abs(error) > 40) {
-		pow = (int) (error*p);
-		if (pow > maxPow) { // cap power at maxPow
-			pow = (pow > 0) ? maxPow:-maxPow;
-		}
-
-		moveDriveMotors(pow, pow);
-		right_pos = right_fwd_mtr.get_position();
-		error = desired_val - right_pos;
-		pros::lcd::set_text(0, "Error: " + std::to_string(error));
-		pros::lcd::set_text(1, "Position: " + std::to_string(right_pos));
-		pros::lcd::set_text(2, "Power: " + std::to_string(pow));
-	}
-	pros::lcd::set_text(0, "Error: " + std::to_string(error));
-	moveDriveMotors(0, 0);
-}
-
-void drive_timed(int millis, int pow = 50) {
-	uint32_t init_time = pros::c::millis();
-	
-	while (pros::c::millis() - init_time < millis) {
-		moveDriveMotors(pow, pow);
+void start_pose_estimate() {
+	if (control_scheduler.add(pose_step) < 0) {
+		printf("pose estimate: every control slot taken, not running\n");
 	}
-
-	moveDriveMotors(0, 0);
 }
 
 // adjust angle to between -180 and 180 degrees
 double adjustAngle(double angle) {
+	angle = fmod(angle, 360);
 	if (angle <= -180) {
-		return angle + 360*(1+floor(-angle/360));
+		return angle + 360;
 	} else if (angle > 180) {
-		return angle - 360*(1+floor(angle/360));
+		return angle - 360;
 	} else {
 		return angle;
 	}
 }
 
-void turn(double angle, int maxPow = 50) {
-	// get gyro angle
-	double gyro_angle = getRotation();
+// follow an S-curve profile while holding the starting heading;
+// maxPow scales the cruise speed like the old power cap
+ControlScheduler::Callback drive_straight_step(double dist, int maxPow) {
+	double maxSpeed = DriveTrain::MAX_SPEED * maxPow / DriveTrain::MAX_POWER;
+	MotionProfile profile(dist, maxSpeed, DRIVE_MAX_ACCEL, DRIVE_JERK_TIME);
+	double start = (drive.getLeftDistance() + drive.getRightDistance()) / 2;
+	double heading = getRotation();
+	uint32_t start_time = pros::millis();
+	ProfileFollower follower(profile, DRIVE_FEEDFORWARD, DRIVE_GAINS, DRIVE_MAX_VOLTAGE, DRIVE_TOLERANCE);
+
+	return [=](double dt) mutable {
+		double t = (pros::millis() - start_time) / 1000.0;
+		double position = (drive.getLeftDistance() + drive.getRightDistance()) / 2 - start;
+		double velocity = (drive.getLeftSpeed() + drive.getRightSpeed()) / 2;
+		int voltage = (int) follower.update(t, position, velocity);
+
+		// positive heading error means we drifted left, so speed up the left side
+		double heading_error = adjustAngle(heading - getRotation());
+		int correction = std::clamp((int) (HEADING_KP * heading_error), -HEADING_MAX_CORRECTION, HEADING_MAX_CORRECTION);
+
+		telemetry.publish(0, "Error", follower.getError());
+		telemetry.publish(1, "Position", position);
+		if (follower.isFinished()) {
+			drive.stop();
+			return true;
+		}
+
+		drive.setVoltage(voltage + correction, voltage - correction);
+		telemetry.publish(2, "Voltage", voltage);
+		telemetry.publish(3, "Heading error", heading_error);
+		return false;
+	};
+}
+
+ControlScheduler::Callback drive_timed_step(int millis, int pow) {
+	uint32_t init_time = pros::c::millis();
+
+	return [=](double dt) {
+		if (pros::c::millis() - init_time >= (uint32_t) millis) {
+			drive.setPower(0, 0);
+			return true;
+		}
+		drive.setPower(pow, pow);
+		return false;
+	};
+}
+
+// Turn constants, voltages in millivolts
+const TurnController::Gains TURN_GAINS = {180, 60, 14, 800, 10};
+const TurnController::Settle TURN_SETTLE = {1.5, 10, 0.1, 2.0};
+
+// turn to an absolute heading (degrees from where resetRotation() was called)
+ControlScheduler::Callback turn_step(double angle, int maxPow) {
+	TurnController controller(TURN_GAINS, TURN_SETTLE, maxPow * DriveTrain::MAX_VOLTAGE / DriveTrain::MAX_POWER);
 
-	double desired_val = angle - gyro_angle;
-	int pow;
-	double p = 0.8;
-	double error = adjustAngle(desired_val - gyro_angle);
+	return [=](double dt) mutable {
+		double error = adjustAngle(angle - getRotation());
+		int voltage = (int) controller.update(dt, error, getRotationRate());
 
-	while(abs(error) > 2) {
-		pow = (int) (error*p);
-		if (pow > 30){
-			pow = (pow > 0) ? maxPow:-maxPow;
+		telemetry.publish(0, "Error", error);
+		if (controller.isFinished()) {
+			drive.stop();
+			return true;
 		}
 
-		moveDriveMotors(pow, -pow); // turn robot right if pow is positive
+		drive.setVoltage(voltage, -voltage); // turn robot right if voltage is positive
+		return false;
+	};
+}
+
+// a straight move scored into score, ending GAIN_CHECK_SECONDS after it starts
+ControlScheduler::Callback gain_check_step(double dist, MoveScore* score) {
+	ControlScheduler::Callback move = drive_straight_step(dist, GAIN_CHECK_POWER);
+	double start = (drive.getLeftDistance() + drive.getRightDistance()) / 2;
+	uint32_t start_time = pros::millis();
+	bool moving = true;
+
+	return [=](double dt) mutable {
+		double t = (pros::millis() - start_time) / 1000.0;
+		double position = (drive.getLeftDistance() + drive.getRightDistance()) / 2 - start;
+		score->add(t, dt, position, (drive.getLeftSpeed() + drive.getRightSpeed()) / 2);
+		if (moving && move(dt)) {
+			moving = false;
+		}
+		return !moving && t + dt >= GAIN_CHECK_SECONDS;
+	};
+}
+
+// Blocking motion primitives, false if the control scheduler had no room
+// for the move
+bool drive_straight(double dist, int maxPow = 50) {
+	return control_scheduler.run(drive_straight_step(dist, maxPow));
+}
+
+bool drive_timed(int millis, int pow = 50) {
+	return control_scheduler.run(drive_timed_step(millis, pow));
+}
+
+bool turn(double angle, int maxPow = 50) {
+	return control_scheduler.run(turn_step(angle, maxPow));
+}
 
-		gyro_angle = getRotation();
-		if (gyro_angle > 180) {
-			gyro_angle -= 360;
+// Drives the gain check moves and prints each one's score to the terminal,
+// to compare with what bin/host/PidTuner predicted for DRIVE_GAINS
+void drive_gain_check() {
+	for (double dist : GAIN_CHECK_MOVES) {
+		MoveScore score(dist, DRIVE_TOLERANCE);
+		if (!control_scheduler.run(gain_check_step(dist, &score))) {
+			return;
 		}
-		error = adjustAngle(desired_val - gyro_angle);
-		pros::lcd::set_text(0, "Error: " + std::to_string(error));
+		printf("gain check %+5.0f in: itae %6.1f, settle %5.2f s, overshoot %5.2f in%s\n", dist, score.getItae(),
+		       score.getSettleTime(), score.getOvershoot(), score.isSettled() ? "" : ", not settled");
 	}
+}
+
+// Subsystems commands can claim
+const uint32_t DRIVE = 1 << 0;
+const uint32_t INTAKE = 1 << 1;
+const uint32_t FLYWHEEL = 1 << 2;
+
+// Command versions of the motion primitives, for use in command groups
+CommandPtr drive_straight_cmd(double dist, int maxPow = 50) {
+	return std::make_shared<StepCommand>([=] { return drive_straight_step(dist, maxPow); }, DRIVE,
+	                                     [] { drive.stop(); });
+}
+
+CommandPtr drive_timed_cmd(int millis, int pow = 50) {
+	return std::make_shared<StepCommand>([=] { return drive_timed_step(millis, pow); }, DRIVE,
+	                                     [] { drive.stop(); });
+}
+
+CommandPtr turn_cmd(double angle, int maxPow = 50) {
+	return std::make_shared<StepCommand>([=] { return turn_step(angle, maxPow); }, DRIVE, [] { drive.stop(); });
+}
+
+CommandPtr intake_cmd(int32_t velocity) {
+	return std::make_shared<InstantCommand>([=] { intake_mtr.move_velocity(velocity); }, INTAKE);
+}
+
+CommandPtr flywheel_cmd(int32_t rpm) {
+	return std::make_shared<InstantCommand>([=] {
+		upper_flywheel.setTarget(rpm);
+		lower_flywheel.setTarget(rpm);
+	}, FLYWHEEL);
+}
+
+CommandPtr wait_cmd(uint32_t millis) {
+	return std::make_shared<WaitCommand>(millis);
+}
+
+bool flywheels_ready() {
+	return upper_flywheel.isAtSpeed() && lower_flywheel.isAtSpeed();
+}
 
-	moveDriveMotors(0, 0);
+// finishes once both flywheels are at speed, or after timeoutMs so a bad
+// wheel cannot stall the routine
+CommandPtr flywheel_ready_cmd(uint32_t timeoutMs) {
+	return race(std::make_shared<WaitUntilCommand>(flywheels_ready), wait_cmd(timeoutMs));
 }
 
 /**
@@ -164,16 +313,27 @@ void initialize() {
 	gyro.reset();
 	resetRotation();
 	pros::lcd::initialize();
+	pros::lcd::register_btn0_cb(on_left_button);
 	pros::lcd::register_btn1_cb(on_center_button);
+	telemetry.start();
+	control_scheduler.start();
+
+	drive.setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
+	drive.setEncoderUnits(pros::E_MOTOR_ENCODER_COUNTS);
+	start_pose_estimate();
+	upper_flywheel.start();
+	lower_flywheel.start();
+}
 
-	right_fwd_mtr.set_brake_mode(pros::E_MOTOR_BRAKE_COAST);
-	right_upp_mtr.set_brake_mode(pros::E_MOTOR_BRAKE_COAST);
-	right_bwd_mtr.set_brake_mode(pros::E_MOTOR_BRAKE_COAST);
-	left_fwd_mtr.set_brake_mode(pros::E_MOTOR_BRAKE_COAST);
-	left_upp_mtr.set_brake_mode(pros::E_MOTOR_BRAKE_COAST);
-	left_bwd_mtr.set_brake_mode(pros::E_MOTOR_BRAKE_COAST);
-	right_fwd_mtr.set_encoder_units(pros::E_MOTOR_ENCODER_COUNTS);
-	left_fwd_mtr.set_encoder_units(pros::E_MOTOR_ENCODER_COUNTS);
+// Cancels every command and drops every control callback but the pose
+// estimate. The canceled commands are ended by the next command tick on the
+// control task, so that gets a couple of periods to run before the callbacks
+// go.
+void stop_control() {
+	command_scheduler.cancelAll();
+	pros::delay(2 * CONTROL_PERIOD_MS);
+	control_scheduler.clear();
+	start_pose_estimate();
 }
 
 /**
@@ -181,7 +341,13 @@ void initialize() {
  * the VEX Competition Switch, following either autonomous or opcontrol. When
  * the robot is enabled, this task will exit.
  */
-void disabled() {}
+void disabled() {
+	// autonomous may have been stopped in the middle of a move
+	stop_control();
+	drive.invalidate();
+	drive.setPower(0, 0);
+	match_recorder.stop();
+}
 
 /**
  * Runs after initialize(), and before autonomous when connected to the Field
@@ -208,6 +374,9 @@ void competition_initialize() {
 	*/
 }
 
+// The routine autonomous() last ran, kept for tools that inspect its steps
+CommandPtr autonomous_routine;
+
 /**
  * Runs the user autonomous code. This function will be started in its own task
  * with the default priority and stack size whenever the robot is enabled via
@@ -220,25 +389,30 @@ void competition_initialize() {
  * from where it left off.
  */
 void autonomous() {
+	drive.invalidate();
 	//drive_straight(-5);
 	//drive_straight(20);
 	//turn(90);
 	//drive_timed(1000);
-	intake_mtr.move_velocity(600);
-	upper_flywheel_mtr.move_velocity(10);
-	lower_flywheel_mtr.move_velocity(10);
-	drive_timed(1000, 75);
-	pros::delay(1000);
-	intake_mtr.move_velocity(100);
-	drive_straight(-5);
-	turn(105);
-	drive_straight(10);
-	intake_mtr.move_velocity(-600);
-	pros::delay(2000);
-	intake_mtr.move_velocity(0);
-	upper_flywheel_mtr.move_velocity(0);
-	lower_flywheel_mtr.move_velocity(0);
-	drive_straight(10);
+	//drive_gain_check();
+	CommandPtr routine = sequence(
+		intake_cmd(600),
+		flywheel_cmd(10),
+		drive_timed_cmd(1000, 75),
+		wait_cmd(1000),
+		intake_cmd(100),
+		drive_straight_cmd(-5),
+		turn_cmd(105),
+		drive_straight_cmd(10),
+		flywheel_ready_cmd(1000),
+		intake_cmd(-600),
+		wait_cmd(2000),
+		intake_cmd(0),
+		flywheel_cmd(0),
+		drive_straight_cmd(10)
+	);
+	autonomous_routine = routine;
+	command_scheduler.runUntilFinished(control_scheduler, routine);
 }
 
 /**
@@ -255,6 +429,11 @@ void autonomous() {
  * task, not resume it from where it left off.
  */
 void opcontrol() {
+	stop_control();
+	drive.invalidate();
+	driver_input.reset();
+	bool recording = match_recorder.start();
+
 	// Flywheel motor speed
 	int32_t flywheel_speed_upper = 10;
 	int32_t flywheel_speed_lower = 10;
@@ -263,50 +442,69 @@ void opcontrol() {
 	uint32_t timeStamp = 0;
 
 	while (true) {
+		uint64_t loop_start = pros::micros();
+		match_recorder.capture();
+
 		// print gyro angle and flywheel speeds
-		pros::lcd::set_text(0, "Angle: " + std::to_string(getRotation()));
-		pros::lcd::set_text(2, "Upper Speed: " + std::to_string(abs(upper_speed_test)));
-		pros::lcd::set_text(3, "Lower Speed: " + std::to_string(abs(lower_speed_test)));
-		pros::lcd::set_text(4, "Left position: " + std::to_string(left_fwd_mtr.get_position()));
-		pros::lcd::set_text(5, "Right position: " + std::to_string(right_fwd_mtr.get_position()));
+		telemetry.publish(0, "Angle", getRotation());
+		ControlScheduler::Stats control_stats = control_scheduler.getStats();
+		telemetry.publish(1, "Ctrl jitter us / overruns", (int) control_stats.maxJitterUs, (int) control_stats.overruns);
+		telemetry.publish(2, "Upper / lower speed", abs(upper_speed_test), abs(lower_speed_test));
+		if (recording) {
+			telemetry.publish(3, "Log frames / dropped", (int) match_recorder.getFrames(),
+			                  (int) match_recorder.getDropped());
+		} else {
+			telemetry.publish(3, "Log: not recording");
+		}
+		telemetry.publish(4, "Left / right position", (int) drive.getLeftPosition(), (int) drive.getRightPosition());
+		if (upper_flywheel.isRecovering() || lower_flywheel.isRecovering()) {
+			telemetry.publish(6, "Flywheel: recovering");
+		} else if (upper_flywheel.isAtSpeed() && lower_flywheel.isAtSpeed()) {
+			telemetry.publish(6, "Flywheel: ready");
+		} else {
+			telemetry.publish(6, "Flywheel: spinning up");
+		}
+		telemetry.publish(7, "Recovery ms",
+		                  (int) std::max(upper_flywheel.getLastRecoveryTime(), lower_flywheel.getLastRecoveryTime()));
+		opcontrol_io_latency.record((uint32_t) (pros::micros() - loop_start));
 
 		// computing joystick inputs for arcade drive
-		int forward_pow = master.get_analog(ANALOG_LEFT_Y);
-		int turn_pow = master.get_analog(ANALOG_RIGHT_X);
-		int left_pow = forward_pow + turn_pow;
-		int right_pow = forward_pow - turn_pow;
+		int forward_pow = match_recorder.analog(ANALOG_LEFT_Y);
+		int turn_pow = match_recorder.analog(ANALOG_RIGHT_X);
+		DriverInput::Output pow = driver_input.arcade(forward_pow, turn_pow);
 
-		// drive motor control (backward motors spin in opposite direction)
-		moveDriveMotors(left_pow, right_pow);
+		// drive motor control
+		drive.setPower(pow.left, pow.right);
 
 		// intake motor control
-		if (master.get_digital(DIGITAL_R1)){
+		if (match_recorder.digital(DIGITAL_R1)){
 			intake_mtr.move_velocity(600);
-		} else if (master.get_digital(DIGITAL_R2)) {
-			intake_mtr.move_velocity(-600);
+		} else if (match_recorder.digital(DIGITAL_R2)) {
+			// feeds the flywheels, so hold the disc while they recover from a shot
+			intake_mtr.move_velocity(flywheels_ready() ? -600 : 0);
 		} else {
 			intake_mtr.move_velocity(100);
 		}
 
 		// flywheel motor control
-		if (master.get_digital_new_press(DIGITAL_A)) {
+		if (match_recorder.newPress(DIGITAL_A)) {
 			flywheel_speed_upper = upper_speed_test;
 			flywheel_speed_lower = lower_speed_test;
-		} else if (master.get_digital_new_press(DIGITAL_X)) {
+		} else if (match_recorder.newPress(DIGITAL_X)) {
 			timeStamp = pros::c::millis();
 			flywheel_speed_upper = 0;
 			flywheel_speed_lower = 0;
 		}
 
 		// manual flywheel adjustment code
-		if (master.get_digital_new_press(DIGITAL_UP) && upper_speed_test > -600) {
+		if (match_recorder.newPress(DIGITAL_UP) && upper_speed_test > -600) {
 			upper_speed_test -= 10;
-		} else if (master.get_digital_new_press(DIGITAL_DOWN) && upper_speed_test < 0) {
+		} else if (match_recorder.newPress(DIGITAL_DOWN) && upper_speed_test < 0) {
 			upper_speed_test += 10;
 		}
-		if (master.get_digital_new_press(DIGITAL_RIGHT) && lower_speed_test > -600) {
+		if (match_recorder.newPress(DIGITAL_RIGHT) && lower_speed_test > -600) {
 			lower_speed_test -= 10;
-		} else if (master.get_digital_new_press(DIGITAL_LEFT) && lower_speed_test < 0) {
+		} else if (match_recorder.newPress(DIGITAL_LEFT) && lower_speed_test < 0) {
 			lower_speed_test += 10;
 		}
 
@@ -316,19 +514,20 @@ void opcontrol() {
 			flywheel_speed_lower = 10;
 			timeStamp = 0;
 		}
-		upper_flywheel_mtr.move_velocity(flywheel_speed_upper);
-		lower_flywheel_mtr.move_velocity(flywheel_speed_lower);
+		upper_flywheel.setTarget(flywheel_speed_upper);
+		lower_flywheel.setTarget(flywheel_speed_lower);
 
 		// wing control
-		if (master.get_digital_new_press(DIGITAL_L2)) {
+		if (match_recorder.newPress(DIGITAL_L2)) {
 			left_wing_piston.set_value(true);
 			right_wing_piston.set_value(true);
-		} else if(master.get_digital_new_press(DIGITAL_L1)) {
+		} else if(match_recorder.newPress(DIGITAL_L1)) {
 			left_wing_piston.set_value(false);
 			right_wing_piston.set_value(false);
 		}
 
 		// hook is a piston, not on robot currently
+		opcontrol_latency.record((uint32_t) (pros::micros() - loop_start));
 		pros::delay(20);
 	}
 }